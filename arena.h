@@ -0,0 +1,42 @@
+/*  A bump allocator for the storage a worker needs while decoding a chunk, all given back at once
+    Copyright (C) 2025 Anonymous1212144
+    See copyright notice in map.cpp
+*/
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <span>
+
+template <typename T>
+class Arena
+{
+public:
+    // One block allocated up front for the largest chunk there can be, which spans are taken from the front
+    // of and which reset() empties again, so that decoding never calls the allocator once a worker has
+    // started. Asking for more than is left gets a shorter span rather than more memory
+    explicit Arena(const size_t capacity) : storage(std::make_unique_for_overwrite<T[]>(capacity)), capacity(capacity) {}
+
+    std::span<T> take(size_t n)
+    {
+        n = std::min(n, capacity - used);
+        std::span<T> s(storage.get() + used, n);
+        used += n;
+        return s;
+    }
+
+    void reset()
+    {
+        used = 0;
+    }
+
+private:
+    std::unique_ptr<T[]> storage;
+    size_t capacity;
+    size_t used = 0;
+};
+
+#endif
@@ -0,0 +1,236 @@
+/*  Benchmarks of each stage of the program on generated worlds, checked against known images
+    Copyright (C) 2025 Anonymous1212144
+    See copyright notice in map.cpp
+*/
+
+#define MCMAP_NO_MAIN
+#include "map.cpp"
+#include "generate.h"
+
+struct BenchCase
+{
+    const char *name;
+    WorldOptions options;
+    int rangex;
+    int rangez;
+    uint32_t checksum; // crc32 of the scanlines of the image, as rendered by the version that set it
+    int shift = 0;     // of the scale, as with --scale
+    Dimension dimension = OVERWORLD;
+};
+
+// regenerate the checksums with --update only when a change is meant to alter the image
+const BenchCase CASES[] = {
+    {"land", {1, 10, 16, 24, 3, ZLIB}, 2, 2, 0x65d383d6},
+    {"ocean", {2, 90, 16, 24, 3, ZLIB}, 2, 2, 0xb78a6bc2},
+    {"wide palette", {3, 30, 2000, 24, 3, ZLIB}, 1, 1, 0x69afa487},
+    {"short world", {4, 30, 16, 8, 3, ZLIB}, 1, 1, 0xcf4f4ade},
+    {"gzip", {5, 30, 16, 24, 3, GZIP}, 1, 1, 0x9c5b9466},
+    {"uncompressed", {6, 30, 16, 24, 3, NONE}, 1, 1, 0x14eab99c},
+    {"lz4", {7, 30, 16, 24, 3, LZ4}, 1, 1, 0x41f1afd8},
+    {"1:4 scale", {1, 10, 16, 24, 3, ZLIB}, 2, 2, 0xf1883580, 2},
+    {"1:16 scale", {2, 90, 16, 24, 3, ZLIB}, 2, 2, 0xcefe5dd5, 4},
+    {"nether", {8, 30, 16, 16, 3, ZLIB, 0, 127}, 1, 1, 0x0250874c, 0, NETHER},
+    {"end", {9, 0, 16, 16, 3, ZLIB, 0}, 1, 1, 0xfb7e80d6, 0, END}};
+
+void report(const char *stage, const double time, const size_t chunks, const size_t bytes)
+{
+    std::cout << "  " << stage << ": " << time * 1000 << " ms";
+    if (chunks)
+        std::cout << ", " << chunks / time << " chunks/s";
+    if (bytes)
+        std::cout << ", " << bytes / time / (1 << 20) << " MB/s";
+    std::cout << "\n";
+}
+
+template <typename D>
+void time_chunks(Job &job, const std::vector<std::array<int, 2>> &regions, double &inflate_time, double &parse_time, double &colour_time, size_t &chunks, size_t &compressed, size_t &inflated)
+{
+    // time the stages of every chunk one at a time
+    Context<D> ctx(job);
+    Tile tile;
+    for (const auto &region : regions)
+    {
+        RegionFile file("r." + std::to_string(region[0]) + "." + std::to_string(region[1]) + ".mca");
+        for (int i = 0; i < 1024; i++)
+        {
+            uint32_t loc = file.location(i);
+            if (!loc)
+                continue;
+            size_t index = static_cast<size_t>(loc >> 8) << 12;
+            uint32_t length;
+            std::memcpy(&length, file.data + index, 4);
+            length = std::byteswap(length) - 1;
+            uint8_t type = file.data[index + 4];
+            clear_chunk(ctx);
+            const uint8_t *src = file.data + index + 5;
+            if (type & EXTERNAL)
+            {
+                const std::vector<uint8_t> *data = ctx.decompressor.read_file("c." + std::to_string((region[0] << 5) + (i & 31)) + "." + std::to_string((region[1] << 5) + (i >> 5)) + ".mcc");
+                if (!data)
+                    continue;
+                src = data->data();
+                length = data->size();
+                type &= ~EXTERNAL;
+            }
+            Clock::time_point start = Clock::now();
+            ctx.ptr = ctx.decompressor.decompress(type, src, length);
+            inflate_time += since(start);
+            if (!ctx.ptr)
+                continue;
+            start = Clock::now();
+            parse(ctx);
+            parse_time += since(start);
+            start = Clock::now();
+            create_colours(ctx, tile, job.scale_shift);
+            colour_time += since(start);
+            chunks++;
+            compressed += length;
+            inflated += ctx.decompressor.size;
+        }
+    }
+}
+
+uint32_t run_case(const BenchCase &test, const std::filesystem::path &dir, const int jobs, const Layout layout)
+{
+    // time the stages of every chunk, then render the whole world and write it out
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    WorldGenerator generator(test.options);
+    std::vector<std::array<int, 2>> regions;
+    for (int z = 0; z < test.rangez; z++)
+        for (int x = 0; x < test.rangex; x++)
+        {
+            generator.write_region(dir, x, z);
+            regions.push_back({x, z});
+        }
+    std::filesystem::current_path(dir);
+    Job job;
+    job.scale_shift = test.shift;
+    job.dimension = test.dimension;
+    job.layout = layout;
+
+    double inflate_time = 0, parse_time = 0, colour_time = 0;
+    size_t chunks = 0, compressed = 0, inflated = 0;
+    if (job.dimension == NETHER)
+        time_chunks<Nether>(job, regions, inflate_time, parse_time, colour_time, chunks, compressed, inflated);
+    else if (job.dimension == END)
+        time_chunks<End>(job, regions, inflate_time, parse_time, colour_time, chunks, compressed, inflated);
+    else
+        time_chunks<Overworld>(job, regions, inflate_time, parse_time, colour_time, chunks, compressed, inflated);
+
+    int bounds[4] = {0, (test.rangex << 9) - 1, 0, (test.rangez << 9) - 1};
+    uint32_t width = test.rangex << (9 - job.scale_shift);
+    uint32_t height = test.rangez << (9 - job.scale_shift);
+    job.frame = make_frame(job, width, bounds, 0, height);
+    allocate_rows(job, std::vector<bool>(test.rangez << 5, true), bounds, 0, height);
+    std::vector<int16_t> north(width, NO_HEIGHT);
+    int count = 0;
+    Clock::time_point start = Clock::now();
+    render_dimension(job, regions, 0, regions.size(), bounds, jobs, count);
+    double render_time = since(start);
+    start = Clock::now();
+    shade_rows(job, north, 0, height, jobs);
+    double shade_time = since(start);
+    std::vector<uint8_t> scratch;
+    start = Clock::now();
+    std::vector<const uint8_t *> rows = job.frame->scanlines(0, height, scratch);
+    PngWriter png("output.png", width, height, 9, jobs);
+    png.write(rows);
+    png.finish();
+    double write_time = since(start);
+
+    std::cout << "\r" << test.name << ": " << regions.size() << " regions, " << chunks << " chunks\n";
+    report("inflate", inflate_time, chunks, inflated);
+    report("parse", parse_time, chunks, inflated);
+    report("create_colours", colour_time, chunks, 0);
+    report("render", render_time, chunks, compressed);
+    report("shade_rows", shade_time, 0, static_cast<size_t>(width) * height);
+    report("write_file", write_time, 0, static_cast<size_t>(width + 1) * height);
+    uint32_t checksum = crc32(0L, Z_NULL, 0);
+    for (const uint8_t *row : rows)
+        checksum = crc32(checksum, row, width + 1);
+    return checksum;
+}
+
+int main(int argc, char *argv[])
+{
+    int jobs = 1;
+    Layout layout = ROWS;
+    bool update = false;
+    std::filesystem::path generate;
+    WorldOptions options;
+    Dimension dimension = OVERWORLD;
+    int rangex = 1, rangez = 1;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc)
+            jobs = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--layout" && i + 1 < argc && parse_layout(argv[i + 1], layout))
+            i++;
+        else if (arg == "--update")
+            update = true;
+        else if (arg == "--generate" && i + 1 < argc)
+            generate = argv[++i];
+        else if (arg == "--size" && i + 2 < argc)
+        {
+            rangex = std::max(1, std::stoi(argv[++i]));
+            rangez = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (arg == "--seed" && i + 1 < argc)
+            options.seed = std::stoull(argv[++i]);
+        else if (arg == "--ocean" && i + 1 < argc)
+            options.ocean = std::clamp(std::stoi(argv[++i]), 0, 100);
+        else if (arg == "--palette" && i + 1 < argc)
+            options.palette = std::clamp(std::stoi(argv[++i]), 0, 4000);
+        else if (arg == "--sections" && i + 1 < argc)
+            options.sections = std::clamp(std::stoi(argv[++i]), 2, 24);
+        else if (arg == "--missing" && i + 1 < argc)
+            options.missing = std::clamp(std::stoi(argv[++i]), 0, 50);
+        else if (arg == "--compression" && i + 1 < argc)
+            options.compression = std::clamp(std::stoi(argv[++i]), 1, 4);
+        else if (arg == "--dimension" && i + 1 < argc && parse_dimension(argv[i + 1], dimension))
+        {
+            // the height and ceiling of the dimension, to be put in DIM-1/region or DIM1/region
+            i++;
+            options.sections = dimension == OVERWORLD ? 24 : 16;
+            options.min_section = dimension == OVERWORLD ? -4 : 0;
+            options.roof = dimension == NETHER ? 127 : -1;
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [-j threads] [--layout rows|tiles] [--update]\n"
+                      << "       " << argv[0] << " --generate dir [--size regions_x regions_z] [--seed n] [--ocean percent] [--palette ores] [--sections n] [--missing percent] [--compression 1-4] [--dimension overworld|nether|end]\n";
+            return 1;
+        }
+    }
+    if (!generate.empty())
+    {
+        // just write a world, for running the program itself on
+        std::filesystem::create_directories(generate);
+        WorldGenerator generator(options);
+        for (int z = 0; z < rangez; z++)
+            for (int x = 0; x < rangex; x++)
+                generator.write_region(generate, x, z);
+        return 0;
+    }
+
+    std::filesystem::path root = std::filesystem::temp_directory_path() / "mcmap-bench";
+    int failed = 0;
+    for (const BenchCase &test : CASES)
+    {
+        uint32_t checksum = run_case(test, root / test.name, jobs, layout);
+        if (update)
+            std::cout << "  checksum: 0x" << std::hex << checksum << std::dec << "\n";
+        else if (checksum != test.checksum)
+        {
+            std::cout << "  checksum 0x" << std::hex << checksum << " does not match 0x" << test.checksum << std::dec << "\n";
+            failed++;
+        }
+    }
+    std::filesystem::current_path(root.parent_path());
+    std::filesystem::remove_all(root);
+    if (failed)
+        std::cout << failed << " of " << std::size(CASES) << " images changed\n";
+    return failed ? 1 : 0;
+}
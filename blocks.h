@@ -0,0 +1,153 @@
+/*  A compile-time perfect hash over the blocks in colours.h
+    Copyright (C) 2025 Anonymous1212144
+    See copyright notice in map.cpp
+*/
+
+#ifndef BLOCKS_H
+#define BLOCKS_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include "colours.h"
+
+enum BlockFlags : uint8_t
+{
+    LOG = 1,
+    BED = 2,
+    WHEAT = 4,
+    WATER = 8,
+    SCAFFOLDING = 16,
+    HALF_BLOCK = 32
+};
+
+constexpr size_t BLOCK_COUNT = std::size(COLOURS);
+constexpr size_t TABLE_SIZE = std::bit_ceil(BLOCK_COUNT);
+constexpr size_t BUCKETS = TABLE_SIZE / 4;
+
+constexpr uint64_t hash_name(const std::string_view name)
+{
+    // FNV-1a
+    uint64_t h = 14695981039346656037ULL;
+    for (char c : name)
+        h = (h ^ static_cast<uint8_t>(c)) * 1099511628211ULL;
+    return h;
+}
+
+constexpr uint64_t mix(uint64_t h, const uint32_t seed)
+{
+    // rehash a name with the seed of its bucket to get its slot in the table
+    h ^= seed * 0x9e3779b97f4a7c15ULL;
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+}
+
+constexpr uint8_t block_flags(const std::string_view name)
+{
+    // properties of a block that change its colour, worked out once from its name
+    uint8_t flags = 0;
+    if (name.ends_with("_log"))
+        flags |= LOG;
+    if (name.ends_with("_bed"))
+        flags |= BED;
+    if (name == "wheat")
+        flags |= WHEAT;
+    if (name == "water")
+        flags |= WATER;
+    if (name == "scaffolding")
+        flags |= SCAFFOLDING;
+    if (name.ends_with("_slab") || name.ends_with("_stairs") || name.ends_with("_trapdoor"))
+        flags |= HALF_BLOCK;
+    return flags;
+}
+
+struct BlockTable
+{
+    std::array<uint16_t, BUCKETS> seeds{};
+    std::array<int16_t, TABLE_SIZE> slots{};
+    std::array<uint8_t, BLOCK_COUNT> flags{};
+    bool valid = true;
+};
+
+constexpr BlockTable build_table()
+{
+    // hash and displace: the largest buckets are placed first, each with the first seed that puts all of
+    // its names in free slots, so that every lookup is a single probe
+    BlockTable table;
+    std::array<uint64_t, BLOCK_COUNT> hashes{};
+    std::array<size_t, BUCKETS + 1> starts{};
+    for (size_t i = 0; i < BLOCK_COUNT; i++)
+    {
+        hashes[i] = hash_name(COLOURS[i].name);
+        table.flags[i] = block_flags(COLOURS[i].name);
+        starts[(hashes[i] & (BUCKETS - 1)) + 1]++;
+    }
+    size_t largest = 0;
+    for (size_t b = 0; b < BUCKETS; b++)
+    {
+        largest = std::max(largest, starts[b + 1]);
+        starts[b + 1] += starts[b];
+    }
+    std::array<size_t, BLOCK_COUNT> members{};
+    std::array<size_t, BUCKETS> filled{};
+    for (size_t i = 0; i < BLOCK_COUNT; i++)
+    {
+        size_t b = hashes[i] & (BUCKETS - 1);
+        members[starts[b] + filled[b]++] = i;
+    }
+
+    table.slots.fill(-1);
+    for (size_t size = largest; size > 0; size--)
+    {
+        for (size_t b = 0; b < BUCKETS; b++)
+        {
+            if (starts[b + 1] - starts[b] != size)
+                continue;
+            uint32_t seed = 0;
+            while (true)
+            {
+                bool fits = true;
+                for (size_t m = starts[b]; m < starts[b + 1] && fits; m++)
+                {
+                    size_t slot = mix(hashes[members[m]], seed) & (TABLE_SIZE - 1);
+                    fits = table.slots[slot] < 0;
+                    for (size_t n = starts[b]; n < m && fits; n++)
+                        fits = (mix(hashes[members[n]], seed) & (TABLE_SIZE - 1)) != slot;
+                }
+                if (fits)
+                    break;
+                if (++seed == 65536)
+                {
+                    // two blocks with the same name
+                    table.valid = false;
+                    return table;
+                }
+            }
+            table.seeds[b] = seed;
+            for (size_t m = starts[b]; m < starts[b + 1]; m++)
+                table.slots[mix(hashes[members[m]], seed) & (TABLE_SIZE - 1)] = members[m];
+        }
+    }
+    return table;
+}
+
+inline constexpr BlockTable BLOCK_TABLE = build_table();
+static_assert(BLOCK_TABLE.valid, "colours.h has a block listed more than once");
+
+constexpr int find_block(const std::string_view name)
+{
+    // index of a block in COLOURS, or -1 if it isn't there
+    uint64_t h = hash_name(name);
+    int i = BLOCK_TABLE.slots[mix(h, BLOCK_TABLE.seeds[h & (BUCKETS - 1)]) & (TABLE_SIZE - 1)];
+    if (i < 0 || COLOURS[i].name != name)
+        return -1;
+    return i;
+}
+
+constexpr uint8_t WATER_COLOUR = COLOURS[find_block("water")].colour & 255;
+
+#endif
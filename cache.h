@@ -0,0 +1,155 @@
+/*  A cache of rendered chunks, so unchanged chunks don't need to be decoded again
+    Copyright (C) 2025 Anonymous1212144
+    See copyright notice in map.cpp
+*/
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+const int16_t NO_HEIGHT = INT16_MIN;
+
+// brightness bits of a pixel that still has to be shaded against the block north of it
+const uint8_t UNSHADED = 3 << 6;
+
+struct Tile
+{
+    // A decoded chunk, before shading: the colour of every column, with water already shaded by its depth
+    // and the rest marked UNSHADED, and the height of every column to shade it and its neighbours with.
+    // Alongside them, for the rasters and counts made in the same pass: the height of the top of each
+    // column above the bottom of the world plus one (0 where nothing is drawn), the water over its floor,
+    // and which block of colours.h is seen (0, air, where nothing is)
+    uint8_t pixels[256];
+    int16_t heights[256];
+    uint16_t surface[256];
+    uint8_t depths[256];
+    uint16_t blocks[256];
+};
+
+struct CacheEntry
+{
+    // the part of a Tile every map needs
+    uint32_t timestamp;
+    uint8_t state;
+    uint8_t pixels[256];
+    int16_t heights[256];
+};
+
+struct CacheExtras
+{
+    // the rest of a Tile, cached only for the runs that make rasters or count blocks
+    uint16_t surface[256];
+    uint8_t depths[256];
+    uint16_t blocks[256];
+};
+
+enum CacheState : uint8_t
+{
+    MISSING,
+    EMPTY,
+    RENDERED
+};
+
+class TileCache
+{
+public:
+    std::vector<CacheEntry> entries;
+    std::vector<CacheExtras> extras; // empty unless the extra planes of each tile are kept
+    bool changed = false;
+
+    explicit TileCache(const bool keep_extras = false) : entries(1024), extras(keep_extras ? 1024 : 0) {}
+
+    bool load(const std::string &path)
+    {
+        // read the cache of a region, leaving it empty if the file is absent, from another version, cut short,
+        // or without the extra planes when they are wanted. A file with them keeps them even when they are
+        // not, so that runs with and without the rasters don't keep rewriting each other's caches
+        std::ifstream file(path, std::ios::binary);
+        char magic[8];
+        uint8_t flags;
+        if (!file.read(magic, 8) || std::memcmp(magic, MAGIC, 8) || !file.read(reinterpret_cast<char *>(&flags), 1))
+            return false;
+        if (!(flags & HAS_EXTRAS) && !extras.empty())
+            return false;
+        if (flags & HAS_EXTRAS)
+            extras.resize(1024);
+        if (file.read(reinterpret_cast<char *>(entries.data()), entries.size() * sizeof(CacheEntry)) && file.read(reinterpret_cast<char *>(extras.data()), extras.size() * sizeof(CacheExtras)))
+            return true;
+        // whatever was read of a short file may be only part of an entry, so every chunk is decoded again
+        entries.assign(entries.size(), CacheEntry{});
+        return false;
+    }
+
+    void save(const std::string &path)
+    {
+        // written beside the old file and renamed over it, so that a run stopped partway, or a full disk,
+        // never leaves a cache cut short
+        std::string temp = path + ".tmp";
+        std::ofstream file(temp, std::ios::binary);
+        uint8_t flags = extras.empty() ? 0 : HAS_EXTRAS;
+        file.write(MAGIC, 8);
+        file.write(reinterpret_cast<const char *>(&flags), 1);
+        file.write(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(CacheEntry));
+        file.write(reinterpret_cast<const char *>(extras.data()), extras.size() * sizeof(CacheExtras));
+        file.close();
+        std::error_code error;
+        if (file)
+            std::filesystem::rename(temp, path, error);
+        else
+            std::filesystem::remove(temp, error);
+    }
+
+    bool find(const int i, const uint32_t timestamp, uint8_t &state, Tile &tile) const
+    {
+        // a chunk is only reused if the region header says it hasn't been saved since it was cached. Its
+        // tile is copied out, leaving the extra planes alone when they aren't kept
+        const CacheEntry &entry = entries[i];
+        if (!timestamp || entry.state == MISSING || entry.timestamp != timestamp)
+            return false;
+        state = entry.state;
+        if (state != RENDERED)
+            return true;
+        std::memcpy(tile.pixels, entry.pixels, sizeof(tile.pixels));
+        std::memcpy(tile.heights, entry.heights, sizeof(tile.heights));
+        if (!extras.empty())
+        {
+            std::memcpy(tile.surface, extras[i].surface, sizeof(tile.surface));
+            std::memcpy(tile.depths, extras[i].depths, sizeof(tile.depths));
+            std::memcpy(tile.blocks, extras[i].blocks, sizeof(tile.blocks));
+        }
+        return true;
+    }
+
+    void store(const int i, const uint32_t timestamp, const uint8_t state, const Tile &tile)
+    {
+        CacheEntry &entry = entries[i];
+        entry.timestamp = timestamp;
+        entry.state = state;
+        if (state == RENDERED)
+        {
+            std::memcpy(entry.pixels, tile.pixels, sizeof(tile.pixels));
+            std::memcpy(entry.heights, tile.heights, sizeof(tile.heights));
+            if (!extras.empty())
+            {
+                std::memcpy(extras[i].surface, tile.surface, sizeof(tile.surface));
+                std::memcpy(extras[i].depths, tile.depths, sizeof(tile.depths));
+                std::memcpy(extras[i].blocks, tile.blocks, sizeof(tile.blocks));
+            }
+        }
+        changed = true;
+    }
+
+private:
+    // bump the version whenever the rendering, the colours or the layout change, so that old caches are
+    // discarded
+    static constexpr char MAGIC[9] = "MCMAPC05";
+    static constexpr uint8_t HAS_EXTRAS = 1;
+};
+
+#endif
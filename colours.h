@@ -1,4 +1,4 @@
-/*  A map that maps block to colour index to the palette in format.h
+/*  A list that maps block to colour index to the palette in format.h, looked up through blocks.h
     Copyright (C) 2025 Anonymous1212144
     See copyright notice in map.cpp
 */
@@ -6,11 +6,16 @@
 #ifndef COLOURS_H
 #define COLOURS_H
 
-#include <string>
 #include <cstdint>
-#include <unordered_map>
+#include <string_view>
 
-inline const std::unordered_map<std::string, uint16_t> COLOURS = {
+struct BlockColour
+{
+    std::string_view name;
+    uint16_t colour;
+};
+
+inline constexpr BlockColour COLOURS[] = {
 {"air",0},{"stone",37},{"granite",27},{"polished_granite",27},{"diorite",57},{"polished_diorite",57},{"andesite",37},{"polished_andesite",37},{"grass_block",22},{"dirt",27},{"coarse_dirt",27},{"podzol",15},{"cobblestone",37},{"oak_planks",25},{"spruce_planks",15},{"birch_planks",47},{"jungle_planks",27},{"acacia_planks",19},{"cherry_planks",46},{"dark_oak_planks",17},{"pale_oak_wood",37},{"pale_oak_planks",57},{"mangrove_planks",16},{"bamboo_planks",20},{"bamboo_mosaic",20},{"oak_sapling",3},{"spruce_sapling",3},{"birch_sapling",3},{"jungle_sapling",3},{"acacia_sapling",3},{"cherry_sapling",48},{"dark_oak_sapling",3},{"pale_oak_sapling",49},{"mangrove_propagule",3},{"bedrock",37},{"water",58},{"lava",1},{"sand",47},{"suspicious_sand",47},{"red_sand",19},{"gravel",37},{"suspicious_gravel",37},{"gold_ore",37},{"deepslate_gold_ore",35},{"iron_ore",37},{"deepslate_iron_ore",35},{"coal_ore",37},{"deepslate_coal_ore",35},{"nether_gold_ore",2},{"oak_log",3865},{"spruce_log",4367},{"birch_log",14639},{"jungle_log",3867},{"acacia_log",9491},{"cherry_log",2094},{"dark_oak_log",4369},{"pale_oak_log",9529},{"mangrove_log",3856},{"mangrove_roots",15},{"muddy_mangrove_roots",15},{"bamboo_block",788},{"stripped_spruce_log",3855},{"stripped_birch_log",12079},{"stripped_jungle_log",6939},{"stripped_acacia_log",4883},{"stripped_cherry_log",7470},{"stripped_dark_oak_log",4369},{"stripped_pale_oak_log",14649},{"stripped_oak_log",6425},{"stripped_mangrove_log",4112},{"stripped_bamboo_block",5140},{"oak_wood",25},{"spruce_wood",15},{"birch_wood",47},{"jungle_wood",27},{"acacia_wood",26},{"cherry_wood",8},{"dark_oak_wood",17},{"mangrove_wood",16},{"stripped_oak_wood",25},{"stripped_spruce_wood",15},{"stripped_birch_wood",47},{"stripped_jungle_wood",27},{"stripped_acacia_wood",19},{"stripped_cherry_wood",29},{"stripped_dark_oak_wood",17},{"stripped_pale_oak_wood",57},{"stripped_mangrove_wood",4112},{"oak_leaves",3},{"spruce_leaves",3},{"birch_leaves",3},{"jungle_leaves",3},{"acacia_leaves",3},{"cherry_leaves",48},{"dark_oak_leaves",3},{"pale_oak_leaves",49},{"mangrove_leaves",3},{"azalea_leaves",3},{"flowering_azalea_leaves",3},{"sponge",20},{"wet_sponge",20},{"glass",0},{"lapis_ore",37},{"deepslate_lapis_ore",35},{"lapis_block",59},{"dispenser",37},{"sandstone",47},{"chiseled_sandstone",47},{"cut_sandstone",47},{"note_block",25},{"white_bed",13629},{"orange_bed",13587},{"magenta_bed",13623},{"light_blue_bed",13624},{"yellow_bed",13588},{"lime_bed",13574},{"pink_bed",13616},{"gray_bed",13594},{"light_gray_bed",13613},{"cyan_bed",13612},{"purple_bed",13618},{"blue_bed",13619},{"brown_bed",13585},{"green_bed",13586},{"red_bed",13584},{"black_bed",13573},{"powered_rail",0},{"detector_rail",0},{"sticky_piston",37},{"cobweb",53},{"short_grass",3},{"fern",3},{"dead_bush",25},{"bush",3},{"short_dry_grass",20},{"tall_dry_grass",20},{"seagrass",58},{"tall_seagrass",58},{"piston",37},{"piston_head",37},{"white_wool",61},{"orange_wool",19},{"magenta_wool",55},{"light_blue_wool",56},{"yellow_wool",20},{"lime_wool",6},{"pink_wool",48},{"gray_wool",26},{"light_gray_wool",45},{"cyan_wool",44},{"purple_wool",50},{"blue_wool",51},{"brown_wool",17},{"green_wool",18},{"red_wool",16},{"black_wool",5},{"moving_piston",37},{"dandelion",3},{"torchflower",3},{"poppy",3},{"blue_orchid",3},{"allium",3},{"azure_bluet",3},{"red_tulip",3},{"orange_tulip",3},{"white_tulip",3},{"pink_tulip",3},{"oxeye_daisy",3},{"cornflower",3},{"wither_rose",3},{"lily_of_the_valley",3},{"brown_mushroom",17},{"red_mushroom",16},{"gold_block",28},{"iron_block",49},{"bricks",16},{"tnt",1},{"bookshelf",25},{"chiseled_bookshelf",25},{"mossy_cobblestone",37},{"obsidian",5},{"torch",0},{"wall_torch",0},{"fire",1},{"soul_fire",56},{"spawner",37},{"creaking_heart",19},{"oak_stairs",25},{"chest",25},{"redstone_wire",0},{"diamond_ore",37},{"deepslate_diamond_ore",35},{"diamond_block",54},{"crafting_table",25},{"wheat",788},{"farmland",27},{"furnace",37},{"oak_sign",25},{"spruce_sign",15},{"birch_sign",47},{"acacia_sign",19},{"cherry_sign",46},{"jungle_sign",27},{"dark_oak_sign",17},{"pale_oak_sign",57},{"mangrove_sign",16},{"bamboo_sign",20},{"oak_door",25},{"ladder",0},{"rail",0},{"cobblestone_stairs",37},{"oak_wall_sign",25},{"spruce_wall_sign",15},{"birch_wall_sign",47},{"acacia_wall_sign",19},{"cherry_wall_sign",46},{"jungle_wall_sign",27},{"dark_oak_wall_sign",17},{"pale_oak_wall_sign",57},{"mangrove_wall_sign",16},{"bamboo_wall_sign",20},{"oak_hanging_sign",25},{"spruce_hanging_sign",15},{"birch_hanging_sign",47},{"acacia_hanging_sign",19},{"cherry_hanging_sign",29},{"jungle_hanging_sign",27},{"dark_oak_hanging_sign",17},{"pale_oak_hanging_sign",57},{"crimson_hanging_sign",33},{"warped_hanging_sign",41},{"mangrove_hanging_sign",16},{"bamboo_hanging_sign",20},{"oak_wall_hanging_sign",25},{"spruce_wall_hanging_sign",25},{"birch_wall_hanging_sign",47},{"acacia_wall_hanging_sign",19},{"cherry_wall_hanging_sign",29},{"jungle_wall_hanging_sign",27},{"dark_oak_wall_hanging_sign",17},{"pale_oak_wall_hanging_sign",57},{"mangrove_wall_hanging_sign",16},{"crimson_wall_hanging_sign",33},{"warped_wall_hanging_sign",41},{"bamboo_wall_hanging_sign",20},{"lever",0},{"stone_pressure_plate",37},{"iron_door",49},{"oak_pressure_plate",25},{"spruce_pressure_plate",15},{"birch_pressure_plate",47},{"jungle_pressure_plate",27},{"acacia_pressure_plate",19},{"cherry_pressure_plate",46},{"dark_oak_pressure_plate",17},{"pale_oak_pressure_plate",57},{"mangrove_pressure_plate",16},{"bamboo_pressure_plate",20},{"redstone_ore",37},{"deepslate_redstone_ore",35},{"redstone_torch",0},{"redstone_wall_torch",0},{"stone_button",0},{"snow",61},{"ice",60},{"snow_block",61},{"cactus",3},{"cactus_flower",48},{"clay",52},{"sugar_cane",3},{"jukebox",27},{"oak_fence",25},{"netherrack",2},{"soul_sand",17},{"soul_soil",17},{"basalt",5},{"polished_basalt",5},{"soul_torch",0},{"soul_wall_torch",0},{"glowstone",47},{"nether_portal",0},{"carved_pumpkin",19},{"jack_o_lantern",19},{"cake",0},{"repeater",0},{"white_stained_glass",61},{"orange_stained_glass",19},{"magenta_stained_glass",55},{"light_blue_stained_glass",56},{"yellow_stained_glass",20},{"lime_stained_glass",6},{"pink_stained_glass",48},{"gray_stained_glass",26},{"light_gray_stained_glass",45},{"cyan_stained_glass",44},{"purple_stained_glass",50},{"blue_stained_glass",51},{"brown_stained_glass",17},{"green_stained_glass",18},{"red_stained_glass",16},{"black_stained_glass",5},{"oak_trapdoor",25},{"spruce_trapdoor",15},{"birch_trapdoor",47},{"jungle_trapdoor",27},{"acacia_trapdoor",19},{"cherry_trapdoor",46},{"dark_oak_trapdoor",17},{"pale_oak_trapdoor",57},{"mangrove_trapdoor",16},{"bamboo_trapdoor",20},{"stone_bricks",37},{"mossy_stone_bricks",37},{"cracked_stone_bricks",37},{"chiseled_stone_bricks",37},{"packed_mud",27},{"mud_bricks",34},{"infested_stone",52},{"infested_cobblestone",52},{"infested_stone_bricks",52},{"infested_mossy_stone_bricks",52},{"infested_cracked_stone_bricks",52},{"infested_chiseled_stone_bricks",52},{"brown_mushroom_block",27},{"red_mushroom_block",16},{"mushroom_stem",53},{"iron_bars",0},{"chain",0},{"glass_pane",0},{"pumpkin",19},{"melon",6},{"attached_pumpkin_stem",3},{"attached_melon_stem",3},{"pumpkin_stem",3},{"melon_stem",3},{"vine",3},{"glow_lichen",43},{"resin_clump",10},{"oak_fence_gate",25},{"brick_stairs",16},{"stone_brick_stairs",37},{"mud_brick_stairs",34},{"mycelium",50},{"lily_pad",3},{"resin_block",10},{"resin_bricks",10},{"resin_brick_stairs",10},{"resin_brick_slab",10},{"resin_brick_wall",10},{"chiseled_resin_bricks",10},{"nether_bricks",2},{"nether_brick_fence",2},{"nether_brick_stairs",2},{"nether_wart",16},{"enchanting_table",16},{"brewing_stand",49},{"cauldron",37},{"water_cauldron",37},{"lava_cauldron",37},{"powder_snow_cauldron",37},{"end_portal",5},{"end_portal_frame",18},{"end_stone",47},{"dragon_egg",5},{"redstone_lamp",10},{"cocoa",3},{"sandstone_stairs",47},{"emerald_ore",37},{"deepslate_emerald_ore",35},{"ender_chest",37},{"tripwire_hook",0},{"tripwire",0},{"emerald_block",23},{"spruce_stairs",15},{"birch_stairs",47},{"jungle_stairs",27},{"command_block",17},{"beacon",54},{"cobblestone_wall",37},{"mossy_cobblestone_wall",37},{"flower_pot",0},{"potted_torchflower",0},{"potted_oak_sapling",0},{"potted_spruce_sapling",0},{"potted_birch_sapling",0},{"potted_jungle_sapling",0},{"potted_acacia_sapling",0},{"potted_cherry_sapling",0},{"potted_dark_oak_sapling",0},{"potted_pale_oak_sapling",0},{"potted_mangrove_propagule",0},{"potted_fern",0},{"potted_dandelion",0},{"potted_poppy",0},{"potted_blue_orchid",0},{"potted_allium",0},{"potted_azure_bluet",0},{"potted_red_tulip",0},{"potted_orange_tulip",0},{"potted_white_tulip",0},{"potted_pink_tulip",0},{"potted_oxeye_daisy",0},{"potted_cornflower",0},{"potted_lily_of_the_valley",0},{"potted_wither_rose",0},{"potted_red_mushroom",0},{"potted_brown_mushroom",0},{"potted_dead_bush",0},{"potted_cactus",0},{"carrots",3},{"potatoes",3},{"oak_button",0},{"spruce_button",0},{"birch_button",0},{"jungle_button",0},{"acacia_button",0},{"cherry_button",0},{"dark_oak_button",0},{"pale_oak_button",0},{"mangrove_button",0},{"bamboo_button",0},{"skeleton_skull",0},{"skeleton_wall_skull",0},{"wither_skeleton_skull",0},{"wither_skeleton_wall_skull",0},{"zombie_head",0},{"zombie_wall_head",0},{"player_head",0},{"player_wall_head",0},{"creeper_head",0},{"creeper_wall_head",0},{"dragon_head",0},{"dragon_wall_head",0},{"piglin_head",0},{"piglin_wall_head",0},{"anvil",49},{"chipped_anvil",49},{"damaged_anvil",49},{"trapped_chest",25},{"light_weighted_pressure_plate",28},{"heavy_weighted_pressure_plate",49},{"comparator",0},{"daylight_detector",25},{"redstone_block",1},{"nether_quartz_ore",2},{"hopper",37},{"quartz_block",57},{"chiseled_quartz_block",57},{"quartz_pillar",57},{"quartz_stairs",57},{"activator_rail",0},{"dropper",37},{"white_terracotta",46},{"orange_terracotta",10},{"magenta_terracotta",36},{"light_blue_terracotta",40},{"yellow_terracotta",11},{"lime_terracotta",21},{"pink_terracotta",29},{"gray_terracotta",8},{"light_gray_terracotta",34},{"cyan_terracotta",32},{"purple_terracotta",30},{"blue_terracotta",31},{"brown_terracotta",9},{"green_terracotta",12},{"red_terracotta",13},{"black_terracotta",4},{"white_stained_glass_pane",0},{"orange_stained_glass_pane",0},{"magenta_stained_glass_pane",0},{"light_blue_stained_glass_pane",0},{"yellow_stained_glass_pane",0},{"lime_stained_glass_pane",0},{"pink_stained_glass_pane",0},{"gray_stained_glass_pane",0},{"light_gray_stained_glass_pane",0},{"cyan_stained_glass_pane",0},{"purple_stained_glass_pane",0},{"blue_stained_glass_pane",0},{"brown_stained_glass_pane",0},{"green_stained_glass_pane",0},{"red_stained_glass_pane",0},{"black_stained_glass_pane",0},{"acacia_stairs",19},{"cherry_stairs",46},{"dark_oak_stairs",17},{"pale_oak_stairs",57},{"mangrove_stairs",16},{"bamboo_stairs",20},{"bamboo_mosaic_stairs",20},{"slime_block",22},{"barrier",0},{"light",0},{"iron_trapdoor",49},{"prismarine",44},{"prismarine_bricks",54},{"dark_prismarine",54},{"prismarine_stairs",44},{"prismarine_brick_stairs",54},{"dark_prismarine_stairs",54},{"prismarine_slab",44},{"prismarine_brick_slab",54},{"dark_prismarine_slab",54},{"sea_lantern",57},{"hay_block",20},{"white_carpet",61},{"orange_carpet",19},{"magenta_carpet",55},{"light_blue_carpet",56},{"yellow_carpet",20},{"lime_carpet",6},{"pink_carpet",48},{"gray_carpet",26},{"light_gray_carpet",45},{"cyan_carpet",44},{"purple_carpet",50},{"blue_carpet",51},{"brown_carpet",17},{"green_carpet",18},{"red_carpet",16},{"black_carpet",5},{"terracotta",19},{"coal_block",5},{"packed_ice",60},{"sunflower",3},{"lilac",3},{"rose_bush",3},{"peony",3},{"tall_grass",3},{"large_fern",3},{"white_banner",25},{"orange_banner",25},{"magenta_banner",25},{"light_blue_banner",25},{"yellow_banner",25},{"lime_banner",25},{"pink_banner",25},{"gray_banner",25},{"light_gray_banner",25},{"cyan_banner",25},{"purple_banner",25},{"blue_banner",25},{"brown_banner",25},{"green_banner",25},{"red_banner",25},{"black_banner",25},{"white_wall_banner",25},{"orange_wall_banner",25},{"magenta_wall_banner",25},{"light_blue_wall_banner",25},{"yellow_wall_banner",25},{"lime_wall_banner",25},{"pink_wall_banner",25},{"gray_wall_banner",25},{"light_gray_wall_banner",25},{"cyan_wall_banner",25},{"purple_wall_banner",25},{"blue_wall_banner",25},{"brown_wall_banner",25},{"green_wall_banner",25},{"red_wall_banner",25},{"black_wall_banner",25},{"red_sandstone",19},{"chiseled_red_sandstone",19},{"cut_red_sandstone",19},{"red_sandstone_stairs",19},{"oak_slab",25},{"spruce_slab",15},{"birch_slab",47},{"jungle_slab",27},{"acacia_slab",19},{"cherry_slab",46},{"dark_oak_slab",17},{"pale_oak_slab",57},{"mangrove_slab",16},{"bamboo_slab",20},{"bamboo_mosaic_slab",20},{"stone_slab",37},{"smooth_stone_slab",37},{"sandstone_slab",47},{"cut_sandstone_slab",47},{"petrified_oak_slab",25},{"cobblestone_slab",37},{"brick_slab",16},{"stone_brick_slab",37},{"mud_brick_slab",34},{"nether_brick_slab",2},{"quartz_slab",57},{"red_sandstone_slab",19},{"cut_red_sandstone_slab",19},{"purpur_slab",55},{"smooth_stone",37},{"smooth_sandstone",47},{"smooth_quartz",57},{"smooth_red_sandstone",19},{"spruce_fence_gate",15},{"birch_fence_gate",47},{"jungle_fence_gate",27},{"acacia_fence_gate",19},{"cherry_fence_gate",46},{"dark_oak_fence_gate",17},{"pale_oak_fence_gate",57},{"mangrove_fence_gate",16},{"bamboo_fence_gate",20},{"spruce_fence",15},{"birch_fence",47},{"jungle_fence",27},{"acacia_fence",19},{"cherry_fence",46},{"dark_oak_fence",17},{"pale_oak_fence",57},{"mangrove_fence",16},{"bamboo_fence",20},{"spruce_door",15},{"birch_door",47},{"jungle_door",27},{"acacia_door",19},{"cherry_door",46},{"dark_oak_door",17},{"pale_oak_door",57},{"mangrove_door",16},{"bamboo_door",20},{"end_rod",0},{"chorus_plant",50},{"chorus_flower",50},{"purpur_block",55},{"purpur_pillar",55},{"purpur_stairs",55},{"end_stone_bricks",47},{"torchflower_crop",3},{"pitcher_crop",3},{"pitcher_plant",3},{"beetroots",3},{"dirt_path",27},{"end_gateway",5},{"repeating_command_block",50},{"chain_command_block",18},{"frosted_ice",60},{"magma_block",2},{"nether_wart_block",16},{"red_nether_bricks",2},{"bone_block",47},{"structure_void",0},{"observer",37},{"shulker_box",50},{"white_shulker_box",61},{"orange_shulker_box",19},{"magenta_shulker_box",55},{"light_blue_shulker_box",56},{"yellow_shulker_box",20},{"lime_shulker_box",6},{"pink_shulker_box",48},{"gray_shulker_box",26},{"light_gray_shulker_box",45},{"cyan_shulker_box",44},{"purple_shulker_box",30},{"blue_shulker_box",51},{"brown_shulker_box",17},{"green_shulker_box",18},{"red_shulker_box",16},{"black_shulker_box",5},{"white_glazed_terracotta",61},{"orange_glazed_terracotta",19},{"magenta_glazed_terracotta",55},{"light_blue_glazed_terracotta",56},{"yellow_glazed_terracotta",20},{"lime_glazed_terracotta",6},{"pink_glazed_terracotta",48},{"gray_glazed_terracotta",26},{"light_gray_glazed_terracotta",45},{"cyan_glazed_terracotta",44},{"purple_glazed_terracotta",50},{"blue_glazed_terracotta",51},{"brown_glazed_terracotta",17},{"green_glazed_terracotta",18},{"red_glazed_terracotta",16},{"black_glazed_terracotta",5},{"white_concrete",61},{"orange_concrete",19},{"magenta_concrete",55},{"light_blue_concrete",56},{"yellow_concrete",20},{"lime_concrete",6},{"pink_concrete",48},{"gray_concrete",26},{"light_gray_concrete",45},{"cyan_concrete",44},{"purple_concrete",50},{"blue_concrete",51},{"brown_concrete",17},{"green_concrete",18},{"red_concrete",16},{"black_concrete",5},{"white_concrete_powder",61},{"orange_concrete_powder",19},{"magenta_concrete_powder",55},{"light_blue_concrete_powder",56},{"yellow_concrete_powder",20},{"lime_concrete_powder",6},{"pink_concrete_powder",48},{"gray_concrete_powder",26},{"light_gray_concrete_powder",45},{"cyan_concrete_powder",44},{"purple_concrete_powder",50},{"blue_concrete_powder",51},{"brown_concrete_powder",17},{"green_concrete_powder",18},{"red_concrete_powder",16},{"black_concrete_powder",5},{"kelp",58},{"kelp_plant",58},{"dried_kelp_block",18},{"turtle_egg",47},{"sniffer_egg",16},{"dried_ghast",26},{"dead_tube_coral_block",26},{"dead_brain_coral_block",26},{"dead_bubble_coral_block",26},{"dead_fire_coral_block",26},{"dead_horn_coral_block",26},{"tube_coral_block",51},{"brain_coral_block",48},{"bubble_coral_block",50},{"fire_coral_block",16},{"horn_coral_block",20},{"dead_tube_coral",26},{"dead_brain_coral",26},{"dead_bubble_coral",26},{"dead_fire_coral",26},{"dead_horn_coral",26},{"tube_coral",51},{"brain_coral",48},{"bubble_coral",50},{"fire_coral",16},{"horn_coral",20},{"dead_tube_coral_fan",26},{"dead_brain_coral_fan",26},{"dead_bubble_coral_fan",26},{"dead_fire_coral_fan",26},{"dead_horn_coral_fan",26},{"tube_coral_fan",51},{"brain_coral_fan",48},{"bubble_coral_fan",50},{"fire_coral_fan",16},{"horn_coral_fan",20},{"dead_tube_coral_wall_fan",26},{"dead_brain_coral_wall_fan",26},{"dead_bubble_coral_wall_fan",26},{"dead_fire_coral_wall_fan",26},{"dead_horn_coral_wall_fan",26},{"tube_coral_wall_fan",51},{"brain_coral_wall_fan",48},{"bubble_coral_wall_fan",50},{"fire_coral_wall_fan",16},{"horn_coral_wall_fan",20},{"sea_pickle",18},{"blue_ice",60},{"conduit",54},{"bamboo_sapling",25},{"bamboo",3},{"potted_bamboo",0},{"void_air",0},{"cave_air",0},{"bubble_column",58},{"polished_granite_stairs",27},{"smooth_red_sandstone_stairs",19},{"mossy_stone_brick_stairs",37},{"polished_diorite_stairs",57},{"mossy_cobblestone_stairs",37},{"end_stone_brick_stairs",47},{"stone_stairs",37},{"smooth_sandstone_stairs",47},{"smooth_quartz_stairs",57},{"granite_stairs",27},{"andesite_stairs",37},{"red_nether_brick_stairs",2},{"polished_andesite_stairs",37},{"diorite_stairs",57},{"polished_granite_slab",27},{"smooth_red_sandstone_slab",19},{"mossy_stone_brick_slab",37},{"polished_diorite_slab",57},{"mossy_cobblestone_slab",37},{"end_stone_brick_slab",47},{"smooth_sandstone_slab",47},{"smooth_quartz_slab",57},{"granite_slab",27},{"andesite_slab",37},{"red_nether_brick_slab",2},{"polished_andesite_slab",37},{"diorite_slab",57},{"brick_wall",16},{"prismarine_wall",44},{"red_sandstone_wall",19},{"mossy_stone_brick_wall",37},{"granite_wall",27},{"stone_brick_wall",37},{"mud_brick_wall",34},{"nether_brick_wall",2},{"andesite_wall",37},{"red_nether_brick_wall",2},{"sandstone_wall",47},{"end_stone_brick_wall",47},{"diorite_wall",57},{"scaffolding",47},{"loom",25},{"barrel",25},{"smoker",37},{"blast_furnace",37},{"cartography_table",25},{"fletching_table",25},{"grindstone",49},{"lectern",25},{"smithing_table",25},{"stonecutter",37},{"bell",28},{"lantern",49},{"soul_lantern",49},{"campfire",15},{"soul_campfire",15},{"sweet_berry_bush",3},{"warped_stem",41},{"stripped_warped_stem",41},{"warped_hyphae",24},{"stripped_warped_hyphae",24},{"warped_nylium",39},{"warped_fungus",44},{"warped_wart_block",38},{"warped_roots",44},{"nether_sprouts",44},{"crimson_stem",33},{"stripped_crimson_stem",33},{"crimson_hyphae",7},{"stripped_crimson_hyphae",7},{"crimson_nylium",14},{"crimson_fungus",2},{"shroomlight",16},{"weeping_vines",2},{"weeping_vines_plant",2},{"twisting_vines",44},{"twisting_vines_plant",44},{"crimson_roots",2},{"crimson_planks",33},{"warped_planks",41},{"crimson_slab",33},{"warped_slab",41},{"crimson_pressure_plate",33},{"warped_pressure_plate",41},{"crimson_fence",33},{"warped_fence",41},{"crimson_trapdoor",33},{"warped_trapdoor",41},{"crimson_fence_gate",33},{"warped_fence_gate",41},{"crimson_stairs",33},{"warped_stairs",41},{"crimson_button",0},{"warped_button",0},{"crimson_door",33},{"warped_door",41},{"crimson_sign",33},{"warped_sign",41},{"crimson_wall_sign",33},{"warped_wall_sign",41},{"structure_block",45},{"jigsaw",45},{"test_block",45},{"test_instance_block",0},{"composter",25},{"target",57},{"bee_nest",20},{"beehive",25},{"honey_block",19},{"honeycomb_block",19},{"netherite_block",5},{"ancient_debris",5},{"crying_obsidian",5},{"respawn_anchor",5},{"potted_crimson_fungus",0},{"potted_warped_fungus",0},{"potted_crimson_roots",0},{"potted_warped_roots",0},{"lodestone",49},{"blackstone",5},{"blackstone_stairs",5},{"blackstone_wall",5},{"blackstone_slab",5},{"polished_blackstone",5},{"polished_blackstone_bricks",5},{"cracked_polished_blackstone_bricks",5},{"chiseled_polished_blackstone",5},{"polished_blackstone_brick_slab",5},{"polished_blackstone_brick_stairs",5},{"polished_blackstone_brick_wall",5},{"gilded_blackstone",5},{"polished_blackstone_stairs",5},{"polished_blackstone_slab",5},{"polished_blackstone_pressure_plate",5},{"polished_blackstone_button",0},{"polished_blackstone_wall",5},{"chiseled_nether_bricks",2},{"cracked_nether_bricks",2},{"quartz_bricks",57},{"candle",47},{"white_candle",53},{"orange_candle",19},{"magenta_candle",55},{"light_blue_candle",56},{"yellow_candle",20},{"lime_candle",6},{"pink_candle",48},{"gray_candle",26},{"light_gray_candle",45},{"cyan_candle",44},{"purple_candle",50},{"blue_candle",51},{"brown_candle",17},{"green_candle",18},{"red_candle",16},{"black_candle",5},{"candle_cake",0},{"white_candle_cake",0},{"orange_candle_cake",0},{"magenta_candle_cake",0},{"light_blue_candle_cake",0},{"yellow_candle_cake",0},{"lime_candle_cake",0},{"pink_candle_cake",0},{"gray_candle_cake",0},{"light_gray_candle_cake",0},{"cyan_candle_cake",0},{"purple_candle_cake",0},{"blue_candle_cake",0},{"brown_candle_cake",0},{"green_candle_cake",0},{"red_candle_cake",0},{"black_candle_cake",0},{"amethyst_block",50},{"budding_amethyst",50},{"amethyst_cluster",50},{"large_amethyst_bud",50},{"medium_amethyst_bud",50},{"small_amethyst_bud",50},{"tuff",8},{"tuff_slab",8},{"tuff_stairs",8},{"tuff_wall",8},{"polished_tuff",8},{"polished_tuff_slab",8},{"polished_tuff_stairs",8},{"polished_tuff_wall",8},{"chiseled_tuff",8},{"tuff_bricks",8},{"tuff_brick_slab",8},{"tuff_brick_stairs",8},{"tuff_brick_wall",8},{"chiseled_tuff_bricks",8},{"calcite",46},{"tinted_glass",26},{"powder_snow",61},{"sculk_sensor",44},{"calibrated_sculk_sensor",44},{"sculk",5},{"sculk_vein",5},{"sculk_catalyst",5},{"sculk_shrieker",5},{"copper_block",19},{"exposed_copper",34},{"weathered_copper",41},{"oxidized_copper",39},{"copper_ore",37},{"deepslate_copper_ore",35},{"oxidized_cut_copper",39},{"weathered_cut_copper",41},{"exposed_cut_copper",34},{"cut_copper",19},{"oxidized_chiseled_copper",39},{"weathered_chiseled_copper",41},{"exposed_chiseled_copper",34},{"chiseled_copper",19},{"waxed_oxidized_chiseled_copper",39},{"waxed_weathered_chiseled_copper",41},{"waxed_exposed_chiseled_copper",34},{"waxed_chiseled_copper",19},{"oxidized_cut_copper_stairs",39},{"weathered_cut_copper_stairs",41},{"exposed_cut_copper_stairs",34},{"cut_copper_stairs",19},{"oxidized_cut_copper_slab",39},{"weathered_cut_copper_slab",41},{"exposed_cut_copper_slab",34},{"cut_copper_slab",19},{"waxed_copper_block",19},{"waxed_weathered_copper",41},{"waxed_exposed_copper",34},{"waxed_oxidized_copper",39},{"waxed_oxidized_cut_copper",39},{"waxed_weathered_cut_copper",41},{"waxed_exposed_cut_copper",34},{"waxed_cut_copper",19},{"waxed_oxidized_cut_copper_stairs",39},{"waxed_weathered_cut_copper_stairs",41},{"waxed_exposed_cut_copper_stairs",34},{"waxed_cut_copper_stairs",19},{"waxed_oxidized_cut_copper_slab",39},{"waxed_weathered_cut_copper_slab",41},{"waxed_exposed_cut_copper_slab",34},{"waxed_cut_copper_slab",19},{"copper_door",19},{"exposed_copper_door",34},{"oxidized_copper_door",39},{"weathered_copper_door",41},{"waxed_copper_door",19},{"waxed_exposed_copper_door",34},{"waxed_oxidized_copper_door",39},{"waxed_weathered_copper_door",41},{"copper_trapdoor",19},{"exposed_copper_trapdoor",34},{"oxidized_copper_trapdoor",39},{"weathered_copper_trapdoor",41},{"waxed_copper_trapdoor",19},{"waxed_exposed_copper_trapdoor",34},{"waxed_oxidized_copper_trapdoor",39},{"waxed_weathered_copper_trapdoor",41},{"copper_grate",19},{"exposed_copper_grate",34},{"weathered_copper_grate",41},{"oxidized_copper_grate",39},{"waxed_copper_grate",19},{"waxed_exposed_copper_grate",34},{"waxed_weathered_copper_grate",41},{"waxed_oxidized_copper_grate",39},{"copper_bulb",19},{"exposed_copper_bulb",34},{"weathered_copper_bulb",41},{"oxidized_copper_bulb",39},{"waxed_copper_bulb",19},{"waxed_exposed_copper_bulb",34},{"waxed_weathered_copper_bulb",41},{"waxed_oxidized_copper_bulb",39},{"lightning_rod",19},{"pointed_dripstone",9},{"dripstone_block",9},{"cave_vines",3},{"cave_vines_plant",3},{"spore_blossom",3},{"azalea",3},{"flowering_azalea",3},{"moss_carpet",18},{"pink_petals",3},{"wildflowers",3},{"leaf_litter",17},{"moss_block",18},{"big_dripleaf",3},{"big_dripleaf_stem",3},{"small_dripleaf",3},{"hanging_roots",27},{"rooted_dirt",27},{"mud",32},{"deepslate",35},{"cobbled_deepslate",35},{"cobbled_deepslate_stairs",35},{"cobbled_deepslate_slab",35},{"cobbled_deepslate_wall",35},{"polished_deepslate",35},{"polished_deepslate_stairs",35},{"polished_deepslate_slab",35},{"polished_deepslate_wall",35},{"deepslate_tiles",35},{"deepslate_tile_stairs",35},{"deepslate_tile_slab",35},{"deepslate_tile_wall",35},{"deepslate_bricks",35},{"deepslate_brick_stairs",35},{"deepslate_brick_slab",35},{"deepslate_brick_wall",35},{"chiseled_deepslate",35},{"cracked_deepslate_bricks",35},{"cracked_deepslate_tiles",35},{"infested_deepslate",35},{"smooth_basalt",5},{"raw_iron_block",42},{"raw_copper_block",19},{"raw_gold_block",28},{"potted_azalea_bush",0},{"potted_flowering_azalea_bush",0},{"ochre_froglight",47},{"verdant_froglight",43},{"pearlescent_froglight",48},{"frogspawn",58},{"reinforced_deepslate",35},{"decorated_pot",13},{"crafter",37},{"trial_spawner",37},{"vault",37},{"heavy_core",49},{"pale_moss_block",45},{"pale_moss_carpet",45},{"pale_hanging_moss",45},{"open_eyeblossom",19},{"closed_eyeblossom",49},{"potted_open_eyeblossom",0},{"potted_closed_eyeblossom",0},{"firefly_bush",3}
 };
 
@@ -0,0 +1,201 @@
+/*  Decoders for the compression types a chunk can be stored with
+    Copyright (C) 2025 Anonymous1212144
+    See copyright notice in map.cpp
+*/
+
+#ifndef DECOMPRESS_H
+#define DECOMPRESS_H
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "zlib.h"
+
+enum Compression : uint8_t
+{
+    GZIP = 1,
+    ZLIB = 2,
+    NONE = 3,
+    LZ4 = 4,
+    EXTERNAL = 128
+};
+
+inline uint32_t read_le32(const uint8_t *ptr)
+{
+    return ptr[0] | ptr[1] << 8 | ptr[2] << 16 | static_cast<uint32_t>(ptr[3]) << 24;
+}
+
+inline bool lz4_block(const uint8_t *src, const size_t length, uint8_t *dst, const size_t size)
+{
+    // decode one raw LZ4 block of exactly size bytes, refusing anything that reads or writes out of bounds
+    const uint8_t *end = src + length;
+    size_t out = 0;
+    while (src < end)
+    {
+        uint8_t token = *src++;
+        size_t literals = token >> 4;
+        if (literals == 15)
+        {
+            uint8_t b;
+            do
+            {
+                if (src == end)
+                    return false;
+                b = *src++;
+                literals += b;
+            } while (b == 255);
+        }
+        if (literals > static_cast<size_t>(end - src) || literals > size - out)
+            return false;
+        std::memcpy(dst + out, src, literals);
+        src += literals;
+        out += literals;
+        if (src == end)
+            break;
+        if (end - src < 2)
+            return false;
+        size_t distance = src[0] | src[1] << 8;
+        src += 2;
+        size_t match = token & 15;
+        if (match == 15)
+        {
+            uint8_t b;
+            do
+            {
+                if (src == end)
+                    return false;
+                b = *src++;
+                match += b;
+            } while (b == 255);
+        }
+        match += 4;
+        if (!distance || distance > out || match > size - out)
+            return false;
+        // matches may overlap what they copy, so a short distance repeats the bytes before it
+        uint8_t *from = dst + out - distance;
+        if (distance >= match)
+            std::memcpy(dst + out, from, match);
+        else
+            for (size_t k = 0; k < match; k++)
+                dst[out + k] = from[k];
+        out += match;
+    }
+    return out == size;
+}
+
+class Decompressor
+{
+public:
+    size_t size = 0; // of the last chunk decoded
+
+    Decompressor()
+    {
+        inflateInit(&strm);
+    }
+
+    ~Decompressor()
+    {
+        inflateEnd(&strm);
+    }
+
+    Decompressor(const Decompressor &) = delete;
+    Decompressor &operator=(const Decompressor &) = delete;
+
+    const uint8_t *decompress(const uint8_t type, const uint8_t *src, const size_t length)
+    {
+        // decode a chunk into the buffer kept between calls, or point straight at it if it is stored
+        // uncompressed. Returns nullptr for unknown types and broken data
+        switch (type)
+        {
+        case GZIP:
+            return inflate_all(src, length, 16 + 15);
+        case ZLIB:
+            return inflate_all(src, length, 15);
+        case NONE:
+            size = length;
+            return src;
+        case LZ4:
+            return lz4_stream(src, length);
+        default:
+            return nullptr;
+        }
+    }
+
+    const std::vector<uint8_t> *read_file(const std::string &path)
+    {
+        // chunks too large for the region file are kept in their own .mcc file, compressed the same way
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+            return nullptr;
+        external.resize(file.tellg());
+        file.seekg(0);
+        if (!file.read(reinterpret_cast<char *>(external.data()), external.size()))
+            return nullptr;
+        return &external;
+    }
+
+private:
+    z_stream strm{};
+    std::vector<uint8_t> buffer = std::vector<uint8_t>(1 << 16);
+    std::vector<uint8_t> external;
+
+    const uint8_t *inflate_all(const uint8_t *src, const size_t length, const int bits)
+    {
+        // inflate in one call, growing the buffer only when a chunk is bigger than any before it
+        inflateReset2(&strm, bits);
+        strm.next_in = const_cast<Bytef *>(src);
+        strm.avail_in = length;
+        size_t used = 0;
+        while (true)
+        {
+            strm.next_out = buffer.data() + used;
+            strm.avail_out = buffer.size() - used;
+            int ret = inflate(&strm, Z_FINISH);
+            used = buffer.size() - strm.avail_out;
+            if (ret == Z_STREAM_END)
+            {
+                size = used;
+                return buffer.data();
+            }
+            if ((ret != Z_OK && ret != Z_BUF_ERROR) || strm.avail_out)
+                return nullptr;
+            buffer.resize(buffer.size() << 1);
+        }
+    }
+
+    const uint8_t *lz4_stream(const uint8_t *src, size_t length)
+    {
+        // the framing of LZ4BlockOutputStream from lz4-java: blocks of a 21 byte header ("LZ4Block", a
+        // method byte, the compressed and decompressed sizes and a checksum) and their data, up to an
+        // empty block
+        size_t used = 0;
+        while (length >= 21 && !std::memcmp(src, "LZ4Block", 8))
+        {
+            uint8_t method = src[8] & 0xF0;
+            size_t packed = read_le32(src + 9);
+            size_t unpacked = read_le32(src + 13);
+            src += 21;
+            length -= 21;
+            if (!unpacked)
+                break;
+            if (packed > length)
+                return nullptr;
+            if (used + unpacked > buffer.size())
+                buffer.resize(std::bit_ceil(used + unpacked));
+            if (method == 0x10 && packed == unpacked)
+                std::memcpy(buffer.data() + used, src, unpacked);
+            else if (method != 0x20 || !lz4_block(src, packed, buffer.data() + used, unpacked))
+                return nullptr;
+            src += packed;
+            length -= packed;
+            used += unpacked;
+        }
+        size = used;
+        return used ? buffer.data() : nullptr;
+    }
+};
+
+#endif
@@ -0,0 +1,64 @@
+/*  The layout of each dimension, as compile time profiles the decoder is specialised for
+    Copyright (C) 2025 Anonymous1212144
+    See copyright notice in map.cpp
+*/
+
+#ifndef DIMENSIONS_H
+#define DIMENSIONS_H
+
+#include <bit>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+enum Dimension
+{
+    OVERWORLD,
+    NETHER,
+    END
+};
+
+// as given to --dimension
+inline const char *const DIMENSION_NAMES[3] = {"overworld", "nether", "end"};
+
+template <int Sections, int MinSection, int Roof>
+struct Profile
+{
+    // Sections counts the 16 block tall sections from the one at MinSection up. Roof is the top block of a
+    // ceiling over the whole dimension that columns are walked from under instead of the heightmap, or -1
+    static constexpr int SECTIONS = Sections;
+    static constexpr int MIN_SECTION = MinSection;
+    static constexpr int ROOF = Roof;
+    // heights count from the bottom of the world, up to one above the top
+    static constexpr int HEIGHT_BITS = std::bit_width(static_cast<unsigned>(Sections << 4));
+    static constexpr int HEIGHTMAP_LONGS = (256 + 64 / HEIGHT_BITS - 1) / (64 / HEIGHT_BITS);
+};
+
+using Overworld = Profile<24, -4, -1>;
+using Nether = Profile<16, 0, 127>;
+using End = Profile<16, 0, -1>;
+
+inline Dimension find_dimension(const std::filesystem::path &dir)
+{
+    // the game keeps the nether's regions in DIM-1/region and the end's in DIM1/region, beside the
+    // overworld's own region folder
+    std::string parent = dir.parent_path().filename().string();
+    if (parent == "DIM-1")
+        return NETHER;
+    if (parent == "DIM1")
+        return END;
+    return OVERWORLD;
+}
+
+inline bool parse_dimension(const std::string_view name, Dimension &dimension)
+{
+    for (int d = 0; d < 3; d++)
+        if (name == DIMENSION_NAMES[d])
+        {
+            dimension = static_cast<Dimension>(d);
+            return true;
+        }
+    return false;
+}
+
+#endif
@@ -0,0 +1,306 @@
+/*  The image being drawn: the colour and height of every pixel in one block of memory, a row or a region at a time
+    Copyright (C) 2025 Anonymous1212144
+    See copyright notice in map.cpp
+*/
+
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+#include "cache.h"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+enum Layout
+{
+    ROWS,
+    TILES
+};
+
+inline bool parse_layout(const std::string &name, Layout &layout)
+{
+    // the layout named on the command line
+    if (name != "rows" && name != "tiles")
+        return false;
+    layout = name == "tiles" ? TILES : ROWS;
+    return true;
+}
+
+class Framebuffer
+{
+public:
+    // Rows [first, last) of an image width pixels wide, in a single mapping backed by huge pages where the
+    // system allows. With ROWS every row of pixels follows a filter byte, so the rows are already the
+    // scanlines of the PNG. With TILES the image is cut into tile by tile squares (a region each, when tile
+    // is a region's width in pixels), stored one after another, where (x_offset, z_offset) is the first
+    // pixel's place in its square, so that drawing a region stays in one square and only has to be put into
+    // rows when it is written. Memory is only committed once touched, so rows without chunks cost nothing.
+    // With rasters, every pixel also has a surface height and a water depth, laid out like its height
+    uint32_t width;
+    size_t first;
+    size_t last;
+    Layout layout;
+    bool rasters;
+
+    Framebuffer(const uint32_t width, const size_t first, const size_t last, const Layout layout = ROWS, const int tile = 512, const int x_offset = 0, const int z_offset = 0, const bool rasters = false)
+        : width(width), first(first), last(last), layout(layout), rasters(rasters), tile(tile), x_offset(x_offset), z_offset(z_offset), in_use(last - first)
+    {
+        if (layout == ROWS)
+        {
+            pixel_bytes = (last - first) * (width + 1);
+            height_count = (last - first) * width;
+        }
+        else
+        {
+            tiles_x = (x_offset + width + tile - 1) / tile;
+            size_t tiles_z = (z_offset + last - first + tile - 1) / tile;
+            pixel_bytes = tiles_x * tiles_z * tile * tile;
+            height_count = pixel_bytes;
+        }
+        // each plane starts on a page of its own, so each can be given back separately
+        size_t heights_at = page_up(pixel_bytes);
+        size_t surface_at = page_up(heights_at + height_count * 2);
+        size_t depths_at = page_up(surface_at + (rasters ? height_count * 2 : 0));
+        allocate(depths_at + (rasters ? height_count : 0));
+        height_base = reinterpret_cast<int16_t *>(base + heights_at);
+        surface_base = reinterpret_cast<uint16_t *>(base + surface_at);
+        depth_base = base + depths_at;
+    }
+
+    ~Framebuffer()
+    {
+#ifndef _WIN32
+        if (base)
+            munmap(base, bytes);
+#endif
+    }
+
+    Framebuffer(const Framebuffer &) = delete;
+    Framebuffer &operator=(const Framebuffer &) = delete;
+
+    void use(const size_t z)
+    {
+        // ready row z to be drawn on, with every height missing; rows never used read as zeros
+        in_use[z - first] = true;
+        for (uint32_t x = 0; x < width; x += run(x))
+            std::fill_n(heights(x, z), run(x), NO_HEIGHT);
+    }
+
+    bool used(const size_t z) const
+    {
+        return in_use[z - first];
+    }
+
+    size_t run(const uint32_t x) const
+    {
+        // how many pixels from x on follow one another in memory
+        return layout == ROWS ? width - x : std::min<size_t>(width - x, tile - (x + x_offset) % tile);
+    }
+
+    uint8_t *pixels(const uint32_t x, const size_t z)
+    {
+        return base + pixel_index(x, z);
+    }
+
+    int16_t *heights(const uint32_t x, const size_t z)
+    {
+        return height_base + sample_index(x, z);
+    }
+
+    uint16_t *surface(const uint32_t x, const size_t z)
+    {
+        return surface_base + sample_index(x, z);
+    }
+
+    uint8_t *depths(const uint32_t x, const size_t z)
+    {
+        return depth_base + sample_index(x, z);
+    }
+
+    void scanline(const size_t z, uint8_t *out)
+    {
+        // copy row z into out, width pixels in order
+        for (uint32_t x = 0; x < width; x += run(x))
+            std::memcpy(out + x, pixels(x, z), run(x));
+    }
+
+    std::vector<const uint8_t *> scanlines(const size_t from, const size_t to, std::vector<uint8_t> &scratch)
+    {
+        // rows [from, to) as PNG scanlines, each starting with its filter byte, or nullptr for a row of
+        // zeros. Rows are pointed to where they are, or put together in scratch from the squares of TILES
+        std::vector<const uint8_t *> lines(to - from);
+        if (layout == TILES)
+            scratch.assign((to - from) * (width + 1), 0);
+        for (size_t z = from; z < to; z++)
+        {
+            if (!used(z))
+                lines[z - from] = nullptr;
+            else if (layout == ROWS)
+                lines[z - from] = pixels(0, z) - 1;
+            else
+            {
+                uint8_t *line = &scratch[(z - from) * (width + 1)];
+                scanline(z, line + 1);
+                lines[z - from] = line;
+            }
+        }
+        return lines;
+    }
+
+    std::vector<const uint16_t *> surface_rows(const size_t from, const size_t to, std::vector<uint16_t> &scratch)
+    {
+        // rows [from, to) of surface heights, or nullptr for a row of zeros
+        return plane_rows(surface_base, from, to, scratch);
+    }
+
+    std::vector<const uint8_t *> depth_rows(const size_t from, const size_t to, std::vector<uint8_t> &scratch)
+    {
+        // rows [from, to) of water depths, or nullptr for a row of zeros
+        return plane_rows(depth_base, from, to, scratch);
+    }
+
+    void release(const size_t from, const size_t to)
+    {
+        // give back the memory of rows [from, to) once they are written. Only whole rows of squares are given
+        // back with TILES, which is every square of a band of regions
+        size_t a = from - first + (layout == TILES ? z_offset : 0);
+        size_t b = to - first + (layout == TILES ? z_offset : 0);
+        size_t end = last - first + (layout == TILES ? z_offset : 0);
+        if (layout == TILES)
+        {
+            // round in to whole rows of squares, except at the top and bottom of the frame, where the rows
+            // of the squares outside the image are never used
+            a = a <= static_cast<size_t>(z_offset) ? 0 : (a + tile - 1) / tile * tile;
+            b = b >= end ? (end + tile - 1) / tile * tile : b / tile * tile;
+            if (a >= b)
+                return;
+        }
+        size_t row = layout == ROWS ? width + 1 : tiles_x * tile;
+        discard(base + a * row, base + b * row);
+        size_t heights_row = layout == ROWS ? width : tiles_x * tile;
+        discard(reinterpret_cast<uint8_t *>(height_base + a * heights_row), reinterpret_cast<uint8_t *>(height_base + b * heights_row));
+        if (rasters)
+        {
+            discard(reinterpret_cast<uint8_t *>(surface_base + a * heights_row), reinterpret_cast<uint8_t *>(surface_base + b * heights_row));
+            discard(depth_base + a * heights_row, depth_base + b * heights_row);
+        }
+    }
+
+private:
+    static constexpr size_t PAGE = 4096;
+    static constexpr size_t HUGE_PAGE = 2 << 20;
+
+    int tile;
+    int x_offset;
+    int z_offset;
+    size_t tiles_x = 0;
+    std::vector<bool> in_use;
+    size_t pixel_bytes;
+    size_t height_count;
+    uint8_t *base = nullptr;
+    int16_t *height_base;
+    uint16_t *surface_base;
+    uint8_t *depth_base;
+    size_t bytes = 0;
+    size_t granule = PAGE;
+#ifdef _WIN32
+    std::unique_ptr<uint8_t[]> memory;
+#endif
+
+    static size_t page_up(const size_t size)
+    {
+        return (size + PAGE - 1) & ~(PAGE - 1);
+    }
+
+    size_t sample_index(const uint32_t x, const size_t z) const
+    {
+        // where a pixel's height (and surface and depth) is in its plane, which has no filter bytes with ROWS
+        return layout == ROWS ? (z - first) * width + x : pixel_index(x, z);
+    }
+
+    template <typename T>
+    std::vector<const T *> plane_rows(T *plane, const size_t from, const size_t to, std::vector<T> &scratch)
+    {
+        // rows [from, to) of a plane, pointed to where they are with ROWS or put together in scratch from the
+        // squares of TILES, and nullptr for rows never used
+        std::vector<const T *> lines(to - from);
+        if (layout == TILES)
+            scratch.assign((to - from) * width, 0);
+        for (size_t z = from; z < to; z++)
+        {
+            if (!used(z))
+                lines[z - from] = nullptr;
+            else if (layout == ROWS)
+                lines[z - from] = plane + sample_index(0, z);
+            else
+            {
+                T *line = &scratch[(z - from) * width];
+                for (uint32_t x = 0; x < width; x += run(x))
+                    std::copy_n(plane + sample_index(x, z), run(x), line + x);
+                lines[z - from] = line;
+            }
+        }
+        return lines;
+    }
+
+    size_t pixel_index(const uint32_t x, const size_t z) const
+    {
+        if (layout == ROWS)
+            return (z - first) * (width + 1) + 1 + x;
+        size_t tx = (x + x_offset) / tile, px = (x + x_offset) % tile;
+        size_t tz = (z - first + z_offset) / tile, pz = (z - first + z_offset) % tile;
+        return ((tz * tiles_x + tx) * tile + pz) * tile + px;
+    }
+
+    void allocate(const size_t size)
+    {
+        // explicit huge pages if enough are reserved for all of it (which is checked when mapping, so that
+        // touching it later can't fail), or else ordinary pages that the kernel is asked to back with
+        // transparent huge pages. Either way the memory starts out as zeros
+#ifdef _WIN32
+        bytes = size;
+        memory = std::make_unique<uint8_t[]>(size);
+        base = memory.get();
+#else
+        bytes = (size + HUGE_PAGE - 1) & ~(HUGE_PAGE - 1);
+        void *map = MAP_FAILED;
+#ifdef MAP_HUGETLB
+        map = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (map != MAP_FAILED)
+            granule = HUGE_PAGE;
+#endif
+        if (map == MAP_FAILED)
+        {
+            map = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (map == MAP_FAILED)
+                throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+            madvise(map, bytes, MADV_HUGEPAGE);
+#endif
+        }
+        base = static_cast<uint8_t *>(map);
+#endif
+    }
+
+    void discard(uint8_t *begin, uint8_t *end)
+    {
+        // the whole pages between begin and end, which read as zeros again if they are touched
+#ifndef _WIN32
+        uintptr_t a = (reinterpret_cast<uintptr_t>(begin) + granule - 1) & ~(granule - 1);
+        uintptr_t b = reinterpret_cast<uintptr_t>(end) & ~(granule - 1);
+        if (a < b)
+            madvise(reinterpret_cast<void *>(a), b - a, MADV_DONTNEED);
+#endif
+    }
+};
+
+#endif
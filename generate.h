@@ -0,0 +1,389 @@
+/*  A generator of synthetic region files, so the program can be measured and checked without a real world
+    Copyright (C) 2025 Anonymous1212144
+    See copyright notice in map.cpp
+*/
+
+#ifndef GENERATE_H
+#define GENERATE_H
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "colours.h"
+#include "decompress.h"
+#include "nbt.h"
+#include "zlib.h"
+
+struct WorldOptions
+{
+    uint64_t seed = 1;
+    int ocean = 30;    // roughly the percentage of columns under the sea
+    int palette = 16;  // number of different ores in the stone, which sets the bits per block underground
+    int sections = 24; // sections per chunk, from the bottom of the world up
+    int missing = 3;   // percentage of chunks left out, and of chunks that haven't finished generating
+    uint8_t compression = ZLIB;
+    int min_section = -4; // Y of the bottom section
+    int roof = -1;        // top of a bedrock ceiling five blocks thick, as in the nether, or -1 for none
+};
+
+class WorldGenerator
+{
+public:
+    WorldGenerator(const WorldOptions &options) : options(options)
+    {
+        // the blocks the terrain is made of, then the ores, picked from all over the colour list
+        states = {{"air", {}},
+                  {"stone", {}},
+                  {"dirt", {}},
+                  {"grass_block", {{"snowy", "false"}}},
+                  {"sand", {}},
+                  {"water", {{"level", "0"}}},
+                  {"oak_log", {{"axis", "y"}}},
+                  {"oak_log", {{"axis", "x"}}},
+                  {"oak_leaves", {{"distance", "1"}, {"persistent", "false"}, {"waterlogged", "false"}}},
+                  {"wheat", {{"age", "7"}}},
+                  {"wheat", {{"age", "3"}}},
+                  {"white_bed", {{"facing", "north"}, {"occupied", "false"}, {"part", "head"}}},
+                  {"white_bed", {{"facing", "north"}, {"occupied", "false"}, {"part", "foot"}}},
+                  {"oak_slab", {{"type", "bottom"}, {"waterlogged", "true"}}},
+                  {"oak_slab", {{"type", "top"}, {"waterlogged", "true"}}},
+                  {"oak_trapdoor", {{"half", "bottom"}, {"open", "true"}, {"waterlogged", "true"}}},
+                  {"oak_trapdoor", {{"half", "top"}, {"open", "false"}, {"waterlogged", "true"}}},
+                  {"kelp", {{"age", "25"}}},
+                  {"glass", {}},
+                  {"deepslate", {{"axis", "y"}}},
+                  {"scaffolding", {{"distance", "0"}, {"waterlogged", "true"}}},
+                  {"gravel", {}}};
+        for (int k = 0; k < options.palette; k++)
+            states.push_back({std::string(COLOURS[(k * 37 + 11) % std::size(COLOURS)].name), {}});
+        bedrock = states.size();
+        states.push_back({"bedrock", {}});
+    }
+
+    void write_region(const std::filesystem::path &dir, const int rx, const int rz)
+    {
+        // a full region file, with any chunk too large for it written to a .mcc file beside it
+        rng = options.seed ^ (static_cast<uint64_t>(static_cast<uint32_t>(rx)) << 32 | static_cast<uint32_t>(rz));
+        std::vector<uint8_t> file(8192);
+        for (int i = 0; i < 1024; i++)
+        {
+            int roll = next() % 100;
+            if (roll < options.missing)
+                continue;
+            int cx = (rx << 5) + (i & 31);
+            int cz = (rz << 5) + (i >> 5);
+            std::vector<uint8_t> data = compress(chunk(cx, cz, roll < 2 * options.missing, i & 1));
+            uint8_t type = options.compression;
+            if (data.size() + 5 > 255 * 4096)
+            {
+                std::ofstream((dir / ("c." + std::to_string(cx) + "." + std::to_string(cz) + ".mcc")).string(), std::ios::binary).write(reinterpret_cast<const char *>(data.data()), data.size());
+                data.clear();
+                type |= EXTERNAL;
+            }
+            size_t offset = file.size();
+            put(file, static_cast<uint32_t>(data.size() + 1), 4);
+            file.push_back(type);
+            file.insert(file.end(), data.begin(), data.end());
+            file.resize((file.size() + 4095) & ~static_cast<size_t>(4095));
+            uint32_t location = static_cast<uint32_t>(offset >> 12) << 8 | static_cast<uint32_t>((file.size() - offset) >> 12);
+            uint32_t timestamp = 1700000000 + i;
+            for (int b = 0; b < 4; b++)
+            {
+                file[(i << 2) + b] = location >> (24 - 8 * b);
+                file[4096 + (i << 2) + b] = timestamp >> (24 - 8 * b);
+            }
+        }
+        std::ofstream((dir / ("r." + std::to_string(rx) + "." + std::to_string(rz) + ".mca")).string(), std::ios::binary).write(reinterpret_cast<const char *>(file.data()), file.size());
+    }
+
+private:
+    struct State
+    {
+        std::string name;
+        std::vector<std::pair<std::string, std::string>> properties;
+    };
+
+    WorldOptions options;
+    std::vector<State> states;
+    uint16_t bedrock;
+    uint64_t rng;
+
+    uint64_t next()
+    {
+        // splitmix64, so the same options always make the same bytes
+        uint64_t z = (rng += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    int noise(const int x, const int z, const int scale, const int amplitude) const
+    {
+        // value noise on a grid of the given scale, in integers so that it is the same on every platform
+        auto corner = [&](int gx, int gz)
+        {
+            uint64_t h = (static_cast<uint64_t>(static_cast<uint32_t>(gx)) << 32 | static_cast<uint32_t>(gz)) * 0x9e3779b97f4a7c15ULL ^ options.seed;
+            h ^= h >> 29;
+            h *= 0xbf58476d1ce4e5b9ULL;
+            return static_cast<int>((h >> 40) % (2 * amplitude + 1)) - amplitude;
+        };
+        int gx = x >= 0 ? x / scale : (x + 1) / scale - 1;
+        int gz = z >= 0 ? z / scale : (z + 1) / scale - 1;
+        int fx = x - gx * scale;
+        int fz = z - gz * scale;
+        int top = corner(gx, gz) * (scale - fx) + corner(gx + 1, gz) * fx;
+        int bottom = corner(gx, gz + 1) * (scale - fx) + corner(gx + 1, gz + 1) * fx;
+        return (top * (scale - fz) + bottom * fz) / (scale * scale);
+    }
+
+    static void put(std::vector<uint8_t> &out, const uint64_t value, const int bytes)
+    {
+        for (int b = bytes - 1; b >= 0; b--)
+            out.push_back(static_cast<uint8_t>(value >> (b << 3)));
+    }
+
+    static void put_string(std::vector<uint8_t> &out, const std::string &s)
+    {
+        put(out, s.size(), 2);
+        out.insert(out.end(), s.begin(), s.end());
+    }
+
+    static void put_tag(std::vector<uint8_t> &out, const uint8_t type, const std::string &name)
+    {
+        out.push_back(type);
+        put_string(out, name);
+    }
+
+    std::vector<uint8_t> chunk(const int cx, const int cz, const bool unfinished, const bool with_heightmap)
+    {
+        // the NBT of one chunk: a column of stone with ores, a grassy or sandy surface, and water up to sea
+        // level, with a few of the blocks that have special colours scattered on top. Unfinished chunks
+        // only have a heightmap every other chunk, like the ones at the edge of a real world
+        int height = options.sections << 4;
+        int ground = options.roof >= 0 ? options.roof - 4 : height;
+        int sea = std::min(126, ground - 12);
+        std::vector<uint16_t> column(height << 8);
+        int ores = std::min(2048, options.palette << 2);
+        for (int k = 0; k < 256; k++)
+        {
+            int x = (cx << 4) + (k & 15);
+            int z = (cz << 4) + (k >> 4);
+            int surface = sea + 2 + noise(x, z, 96, 36) + noise(x, z, 24, 8) + static_cast<int>(next() % 3) - (options.ocean - 50) * 84 / 100;
+            surface = std::clamp(surface, 5, ground - 10);
+            uint16_t *c = &column[k * height];
+            for (int h = ground; h <= options.roof; h++)
+                c[h] = bedrock;
+            for (int h = 0; h < surface; h++)
+            {
+                uint64_t r = next();
+                if (options.palette && static_cast<int>(r % 4096) < ores)
+                    c[h] = 22 + (r >> 12) % options.palette;
+                else
+                    c[h] = h < 64 ? 19 : h < surface - 4 ? 1 : 2;
+            }
+            uint64_t r = next();
+            if (surface < sea)
+            {
+                c[surface] = r % 7 ? 4 : 21;
+                for (int h = surface + 1; h <= sea; h++)
+                    c[h] = 5;
+                if (r % 11 == 1)
+                    for (int h = surface + 1; h < std::min(sea, surface + 8); h++)
+                        c[h] = 17;
+                else if (r % 13 == 2)
+                    c[surface + 1] = 13 + (r >> 8) % 4;
+                else if (r % 37 == 3)
+                    c[surface + 1] = 20;
+                else if (r % 41 == 4 && surface + 3 < sea)
+                    c[surface + 3] = 18;
+            }
+            else
+            {
+                c[surface] = 3;
+                int m = r % 60;
+                if (m < 3)
+                {
+                    for (int h = surface + 1; h < surface + 5; h++)
+                        c[h] = 6;
+                    c[surface + 5] = 8;
+                }
+                else if (m < 5)
+                    c[surface + 1] = 7;
+                else if (m < 8)
+                    c[surface + 1] = 9 + (m & 1);
+                else if (m < 10)
+                    c[surface + 1] = 11 + (m & 1);
+                else if (m < 12)
+                    c[surface + 2] = 18;
+            }
+        }
+
+        std::vector<uint8_t> out;
+        put_tag(out, TAG_COMPOUND, "");
+        put_tag(out, TAG_INT, "DataVersion");
+        put(out, 4440, 4);
+        put_tag(out, TAG_INT, "xPos");
+        put(out, static_cast<uint32_t>(cx), 4);
+        put_tag(out, TAG_INT, "zPos");
+        put(out, static_cast<uint32_t>(cz), 4);
+        put_tag(out, TAG_INT, "yPos");
+        put(out, static_cast<uint32_t>(options.min_section), 4);
+        put_tag(out, TAG_STRING, "Status");
+        put_string(out, unfinished ? "minecraft:features" : "minecraft:full");
+        put_tag(out, TAG_LONG, "LastUpdate");
+        put(out, next(), 8);
+        put_tag(out, TAG_LIST, "block_entities");
+        out.push_back(TAG_END);
+        put(out, 0, 4);
+        put_tag(out, TAG_LIST, "sections");
+        out.push_back(TAG_COMPOUND);
+        put(out, options.sections, 4);
+        for (int s = 0; s < options.sections; s++)
+        {
+            put_tag(out, TAG_BYTE, "Y");
+            out.push_back(static_cast<uint8_t>(s + options.min_section));
+            std::vector<uint16_t> indices(4096);
+            std::vector<int> palette;
+            std::vector<int> lookup(states.size(), -1);
+            for (int e = 0; e < 4096; e++)
+            {
+                uint16_t id = column[(e & 255) * height + (s << 4) + (e >> 8)];
+                if (lookup[id] < 0)
+                {
+                    lookup[id] = palette.size();
+                    palette.push_back(id);
+                }
+                indices[e] = lookup[id];
+            }
+            put_tag(out, TAG_COMPOUND, "block_states");
+            put_tag(out, TAG_LIST, "palette");
+            out.push_back(TAG_COMPOUND);
+            put(out, palette.size(), 4);
+            for (int id : palette)
+            {
+                put_tag(out, TAG_STRING, "Name");
+                put_string(out, "minecraft:" + states[id].name);
+                if (states[id].properties.size())
+                {
+                    put_tag(out, TAG_COMPOUND, "Properties");
+                    for (const auto &[key, value] : states[id].properties)
+                    {
+                        put_tag(out, TAG_STRING, key);
+                        put_string(out, value);
+                    }
+                    out.push_back(TAG_END);
+                }
+                out.push_back(TAG_END);
+            }
+            if (palette.size() > 1)
+            {
+                int bits = std::max(4, static_cast<int>(std::bit_width(palette.size() - 1)));
+                int per = 64 / bits;
+                int longs = (4096 + per - 1) / per;
+                put_tag(out, TAG_LONG_ARRAY, "data");
+                put(out, longs, 4);
+                for (int l = 0; l < longs; l++)
+                {
+                    uint64_t v = 0;
+                    for (int e = 0; e < per && l * per + e < 4096; e++)
+                        v |= static_cast<uint64_t>(indices[l * per + e]) << (e * bits);
+                    put(out, v, 8);
+                }
+            }
+            out.push_back(TAG_END);
+            put_tag(out, TAG_COMPOUND, "biomes");
+            put_tag(out, TAG_LIST, "palette");
+            out.push_back(TAG_STRING);
+            put(out, 1, 4);
+            put_string(out, "minecraft:plains");
+            out.push_back(TAG_END);
+            put_tag(out, TAG_BYTE_ARRAY, "BlockLight");
+            put(out, 2048, 4);
+            out.resize(out.size() + 2048);
+            out.push_back(TAG_END);
+        }
+        if (!unfinished || with_heightmap)
+        {
+            put_tag(out, TAG_COMPOUND, "Heightmaps");
+            for (const char *name : {"MOTION_BLOCKING", "WORLD_SURFACE", "OCEAN_FLOOR"})
+            {
+                put_tag(out, TAG_LONG_ARRAY, name);
+                put(out, 37, 4);
+                for (int l = 0; l < 37; l++)
+                {
+                    uint64_t v = 0;
+                    for (int e = 0; e < 7 && l * 7 + e < 256; e++)
+                    {
+                        int k = l * 7 + e;
+                        int top = height - 1;
+                        while (top >= 0 && !column[k * height + top])
+                            top--;
+                        v |= static_cast<uint64_t>(top + 1) << (e * 9);
+                    }
+                    put(out, v, 8);
+                }
+            }
+            out.push_back(TAG_END);
+        }
+        out.push_back(TAG_END);
+        return out;
+    }
+
+    std::vector<uint8_t> compress(const std::vector<uint8_t> &raw) const
+    {
+        // encode a chunk with the compression type from the options
+        std::vector<uint8_t> out;
+        if (options.compression == GZIP || options.compression == ZLIB)
+        {
+            z_stream strm{};
+            deflateInit2(&strm, 6, Z_DEFLATED, options.compression == GZIP ? 16 + 15 : 15, 8, Z_DEFAULT_STRATEGY);
+            out.resize(deflateBound(&strm, raw.size()));
+            strm.next_in = const_cast<Bytef *>(raw.data());
+            strm.avail_in = raw.size();
+            strm.next_out = out.data();
+            strm.avail_out = out.size();
+            deflate(&strm, Z_FINISH);
+            out.resize(out.size() - strm.avail_out);
+            deflateEnd(&strm);
+        }
+        else if (options.compression == LZ4)
+        {
+            // LZ4BlockOutputStream framing around blocks of nothing but literals, which any decoder accepts
+            auto header = [&](const uint8_t method, const uint32_t packed, const uint32_t size)
+            {
+                out.insert(out.end(), {'L', 'Z', '4', 'B', 'l', 'o', 'c', 'k'});
+                out.push_back(method | 6);
+                for (uint32_t v : {packed, size, 0u})
+                    for (int b = 0; b < 4; b++)
+                        out.push_back(static_cast<uint8_t>(v >> (b << 3)));
+            };
+            for (size_t begin = 0; begin < raw.size(); begin += 65536)
+            {
+                size_t size = std::min<size_t>(65536, raw.size() - begin);
+                std::vector<uint8_t> block;
+                block.push_back(std::min<size_t>(size, 15) << 4);
+                if (size >= 15)
+                {
+                    size_t n = size - 15;
+                    for (; n >= 255; n -= 255)
+                        block.push_back(255);
+                    block.push_back(n);
+                }
+                block.insert(block.end(), raw.begin() + begin, raw.begin() + begin + size);
+                header(0x20, block.size(), size);
+                out.insert(out.end(), block.begin(), block.end());
+            }
+            header(0x10, 0, 0);
+        }
+        else
+            out = raw;
+        return out;
+    }
+};
+
+#endif
@@ -17,52 +17,131 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <bit>
+#include <charconv>
 #include <chrono>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <span>
 #include <sstream>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <thread>
 #include <unordered_set>
 #include <vector>
-#include "colours.h"
+#include "arena.h"
+#include "blocks.h"
+#include "cache.h"
+#include "decompress.h"
+#include "dimensions.h"
 #include "format.h"
+#include "framebuffer.h"
+#include "mcmap.h"
+#include "nbt.h"
+#include "pipeline.h"
+#include "png.h"
+#include "raster.h"
+#include "raw.h"
+#include "region.h"
+#include "shade.h"
+#include "stats.h"
+#include "tiles.h"
+#include "unpack.h"
 #include "zlib.h"
 
-const int infos[13][2] = {{0, 0}, {1, 0}, {2, 0}, {4, 0}, {8, 0}, {4, 0}, {8, 0}, {2, 1}, {2, 0}, {5, 0}, {0, 0}, {2, 4}, {2, 8}};
-const std::unordered_set<std::string> interesting = {"Heightmaps", "Name", "Properties", "WORLD_SURFACE", "Y", "age", "axis", "block_states", "data", "half", "open", "palette", "part", "sections", "type", "waterlogged"};
-const std::unordered_set<std::string> prop_types = {"age", "axis", "half", "open", "part", "type", "waterlogged"};
+// room for the unpacked indices of a section, with space for the last long's spare entries and the
+// unpacker's slack, so that unpacking a section never writes over the one above it
+const int SECTION_INDICES = 4096 + 16 + UNPACK_SLACK;
+// the most entries a section's palette can have, one for each of its blocks, and the most longs its indices
+// take, at the 12 bits a block that needs
+const int MAX_PALETTE = 4096;
+const int SECTION_LONGS = (4096 + 64 / 12 - 1) / (64 / 12);
 
-uint64_t heightmap[37];
-bool map_set;
-std::vector<uint8_t> palette[25];
-std::vector<uint64_t> blocks[25];
-bool blocks_set[25] = {};
-std::vector<std::vector<uint8_t>> output;
+struct Job
+{
+    // Everything one render shares between its workers: how to draw, the image being drawn on, and what is
+    // counted and reported along the way. Nothing is kept outside it, so separate renders (from the library
+    // entry points in mcmap.h as well) can run on separate threads without touching each other
+    std::filesystem::path cache_dir;
+    int scale_shift = 0;
+    Dimension dimension = OVERWORLD;
+    bool quiet = false; // no warnings or progress printed
+    Layout layout = ROWS;
+    bool rasters = false;      // keep the surface height and water depth of every pixel too
+    bool count_blocks = false; // count the blocks seen in each region
+    std::shared_ptr<Framebuffer> frame; // the rows being drawn on, which the writer holds on to until written
+    std::unordered_set<std::string> invalids;
+    std::mutex io_mutex;
+    std::vector<Stats> thread_stats;
+    std::vector<RegionStats> region_stats;
+    std::vector<std::vector<uint64_t>> region_blocks; // by block of colours.h, for each region
+    BandTracker band_tracker;
+    double progress_interval = 0;
+    Clock::time_point last_progress;
+    uint64_t progress_chunks = 0;
+};
+
+template <typename D>
+struct Context
+{
+    // Decode state of a single worker, so that regions can be processed in parallel, sized for the sections
+    // of dimension D
+    explicit Context(Job &job) : job(job) {}
+
+    Job &job;
+    uint64_t heightmap[D::HEIGHTMAP_LONGS];
+    uint16_t heights[256 + UNPACK_SLACK];
+    bool map_set;
+    Arena<uint8_t> arena = Arena<uint8_t>(D::SECTIONS * MAX_PALETTE);
+    std::span<uint8_t> palette[D::SECTIONS];
+    Arena<uint16_t> id_arena = Arena<uint16_t>(D::SECTIONS * MAX_PALETTE);
+    std::span<uint16_t> block_ids[D::SECTIONS]; // the block of colours.h behind each palette entry
+    std::vector<uint64_t> block_counts; // of the region being drawn, when the Job counts blocks
+    std::vector<uint16_t> indices = std::vector<uint16_t>(D::SECTIONS * SECTION_INDICES);
+    bool blocks_set[D::SECTIONS] = {};
+    const uint8_t *palettes[D::SECTIONS];
+    uint32_t palette_sizes[D::SECTIONS] = {};
+    bool decoded[D::SECTIONS] = {};
+    const uint8_t *data[D::SECTIONS];
+    uint32_t longs[D::SECTIONS];
+    std::vector<uint16_t> visible = std::vector<uint16_t>(D::SECTIONS << 8);
+    std::vector<uint16_t> dry = std::vector<uint16_t>(D::SECTIONS << 8);
+    bool summarised[D::SECTIONS] = {};
+    bool unpacked[D::SECTIONS] = {};
+    uint8_t kinds[MAX_PALETTE];
 
-const uint8_t *ptr;
-int prop_temp = 0;
-std::string name_temp;
-std::vector<uint64_t> blocks_temp;
-bool b_temp_set = false;
-std::vector<uint8_t> palette_temp;
-uint8_t y = 0;
-std::unordered_set<std::string> invalids;
+    const uint8_t *ptr;
+    int prop_temp = 0;
+    std::string_view name_temp;
+    uint64_t blocks_temp[SECTION_LONGS];
+    const uint8_t *data_temp = nullptr;
+    uint32_t longs_temp = 0;
+    const uint8_t *palette_temp = nullptr;
+    uint32_t palette_size_temp = 0;
+    uint8_t y = 0;
 
-inline int check_water(const std::string &name, const int prop)
+    Decompressor decompressor;
+    Stats stats;
+};
+
+inline int check_water(const int block, const int prop)
 {
     // Check whether a block counts as water and/or displays as water
-    if (name == "water")
+    uint8_t flags = BLOCK_TABLE.flags[block];
+    if (flags & WATER)
         return 3;
     if (!(prop & 1))
         return 0;
-    if (name == "scaffolding")
+    if (flags & SCAFFOLDING)
         return 2;
-    if (name.ends_with("_slab") || name.ends_with("_stairs") || name.ends_with("_trapdoor"))
+    if (flags & HALF_BLOCK)
     {
         if (prop & 2)
             return 3;
@@ -71,525 +150,1144 @@ inline int check_water(const std::string &name, const int prop)
     return 3;
 }
 
-inline uint8_t process_name(const std::string &name, const int prop)
+inline uint8_t process_name(Job &job, const std::string_view name, const int prop, uint16_t &id)
 {
-    // Convert block name to bytes representing its colour
-    auto pair = COLOURS.find(name);
-    if (pair == COLOURS.end() && !invalids.contains(name))
+    // Convert block name to bytes representing its colour, with a single probe of the table in blocks.h,
+    // and set id to the block's place in colours.h (air if it isn't there)
+    int block = find_block(name);
+    id = std::max(block, 0);
+    if (block < 0)
     {
-        std::cerr << "\nCannot find colour data for \"" << name << "\", defaulting to void\n";
-        invalids.insert(name);
+        std::lock_guard<std::mutex> lock(job.io_mutex);
+        if (job.invalids.emplace(name).second && !job.quiet)
+            std::cerr << "\nCannot find colour data for \"" << name << "\", defaulting to void\n";
         return 0;
     }
-    uint16_t colour = pair->second;
-    if (name.ends_with("_log"))
+    uint16_t colour = COLOURS[block].colour;
+    uint8_t flags = BLOCK_TABLE.flags[block];
+    if (flags & LOG)
+        return prop & 4 ? colour & 255 : colour >> 8;
+    else if (flags & BED)
+        return prop & 8 ? colour & 255 : colour >> 8;
+    else if (flags & WHEAT)
+        return prop & 32 ? colour & 255 : colour >> 8;
+    else
+        return (check_water(block, prop) << 6) | (colour & 255);
+}
+
+inline void read_longs(const uint8_t *&ptr, uint64_t *out, const uint32_t n)
+{
+    // copy a big endian long array out of the chunk
+    KERNELS.byteswap(ptr, out, n);
+    ptr += static_cast<size_t>(n) * 8;
+}
+
+template <typename D>
+inline int parse_properties(Context<D> &ctx)
+{
+    // gather the block state properties that change the colour into bits
+    int prop = 0;
+    scan_compound(ctx.ptr, [&](uint8_t type, std::string_view key)
+                  {
+        if (type != TAG_STRING)
+            return false;
+        std::string_view value = read_string(ctx.ptr);
+        if (key == "waterlogged")
+        {
+            if (value == "true")
+                prop |= 1;
+        }
+        else if (key == "axis")
+        {
+            if (value == "y")
+                prop |= 4;
+        }
+        else if (key == "part")
+        {
+            if (value == "head")
+                prop |= 8;
+        }
+        else if (key == "open")
+        {
+            if (value == "true")
+                prop |= 16;
+        }
+        else if (key == "age")
+        {
+            int age = 0;
+            std::from_chars(value.data(), value.data() + value.size(), age);
+            if (age >= 6)
+                prop |= 32;
+        }
+        else if (key == "half" || key == "type")
+        {
+            if (value == "bottom")
+                prop |= 2;
+        }
+        return true; });
+    return prop;
+}
+
+inline int index_bits(const size_t size)
+{
+    // bits per block of the indices into a palette of size entries
+    return std::max(4, static_cast<int>(std::bit_width<unsigned>(std::max<size_t>(size, 1) - 1)));
+}
+
+template <typename D>
+inline void parse_palette(Context<D> &ctx, const int y)
+{
+    // resolve the block names of a section's palette into colours, in the chunk's arena. Room is taken for
+    // every index the section's bits per block can hold, and the ones past the end of the palette are void
+    // (as in block_at), so that an unpacked index can be looked up through data() without checking it
+    ctx.stats.palettes++;
+    uint32_t size = std::min<uint32_t>(ctx.palette_sizes[y], MAX_PALETTE);
+    std::span<uint8_t> palette = ctx.arena.take(1 << index_bits(size));
+    std::fill(palette.begin() + size, palette.end(), 0);
+    ctx.palette[y] = palette.first(size);
+    std::span<uint16_t> ids = ctx.id_arena.take(1 << index_bits(size));
+    std::fill(ids.begin() + size, ids.end(), 0);
+    ctx.block_ids[y] = ids;
+    ctx.ptr = ctx.palettes[y];
+    for (uint32_t e = 0; e < size; e++)
     {
-        if (prop & 4)
-            return colour & 255;
-        else
-            return colour >> 8;
+        ctx.prop_temp = 0;
+        scan_compound(ctx.ptr, [&](uint8_t type, std::string_view name)
+                      {
+            if (type == TAG_STRING && name == "Name")
+            {
+                ctx.name_temp = read_string(ctx.ptr);
+                ctx.name_temp.remove_prefix(std::min<size_t>(10, ctx.name_temp.size()));
+                return true;
+            }
+            if (type == TAG_COMPOUND && name == "Properties")
+            {
+                ctx.prop_temp = parse_properties(ctx);
+                return true;
+            }
+            return false; });
+        palette[e] = process_name(ctx.job, ctx.name_temp, ctx.prop_temp, ids[e]);
     }
-    else if (name.ends_with("_bed"))
+    ctx.decoded[y] = true;
+}
+
+template <typename D>
+inline std::span<const uint8_t> section_palette(Context<D> &ctx, const int y)
+{
+    // a section's palette, resolved the first time a column reaches the section
+    if (!ctx.decoded[y])
+        parse_palette(ctx, y);
+    return ctx.palette[y];
+}
+
+template <typename D>
+inline void parse_block_states(Context<D> &ctx)
+{
+    // the palette of a section and the packed indices into it, which are only noted here and decoded if a
+    // column reaches them
+    scan_compound(ctx.ptr, [&](uint8_t type, std::string_view name)
+                  {
+        if (type == TAG_LIST && name == "palette" && *ctx.ptr == TAG_COMPOUND)
+        {
+            const uint8_t *start = ctx.ptr;
+            ctx.ptr++;
+            ctx.palette_size_temp = read_u32(ctx.ptr);
+            ctx.palette_temp = ctx.ptr;
+            skip_payload(start, TAG_LIST);
+            ctx.ptr = start;
+            return true;
+        }
+        if (type == TAG_LONG_ARRAY && name == "data")
+        {
+            ctx.longs_temp = read_u32(ctx.ptr);
+            ctx.data_temp = ctx.ptr;
+            ctx.ptr += static_cast<size_t>(ctx.longs_temp) * 8;
+            return true;
+        }
+        return false; });
+}
+
+template <typename D>
+inline void parse_section(Context<D> &ctx)
+{
+    // one 16 block tall section, kept if it is inside the world
+    ctx.stats.sections++;
+    scan_compound(ctx.ptr, [&](uint8_t type, std::string_view name)
+                  {
+        if (type == TAG_BYTE && name == "Y")
+        {
+            ctx.y = static_cast<int8_t>(*ctx.ptr++) - D::MIN_SECTION;
+            return true;
+        }
+        if (type == TAG_COMPOUND && name == "block_states")
+        {
+            parse_block_states(ctx);
+            return true;
+        }
+        return false; });
+    if (ctx.y < D::SECTIONS)
     {
-        if (prop & 8)
-            return colour & 255;
-        else
-            return colour >> 8;
+        ctx.palettes[ctx.y] = ctx.palette_temp;
+        ctx.palette_sizes[ctx.y] = ctx.palette_size_temp;
+        ctx.blocks_set[ctx.y] = ctx.longs_temp;
+        ctx.data[ctx.y] = ctx.data_temp;
+        ctx.longs[ctx.y] = ctx.longs_temp;
     }
-    else if (name == "wheat")
+    ctx.palette_size_temp = 0;
+    ctx.longs_temp = 0;
+}
+
+template <typename D>
+inline void unpack_section(Context<D> &ctx, const int y)
+{
+    // spread the packed palette indices of a section out into one entry per block, so that reading a
+    // block is a single array access. Only done the first time the walk down a column reaches the section
+    int n = index_bits(section_palette(ctx, y).size());
+    int d = 64 / n;
+    uint32_t count = (4096 + d - 1) / d;
+    uint32_t longs = std::min(count, ctx.longs[y]);
+    KERNELS.byteswap(ctx.data[y], ctx.blocks_temp, longs);
+    std::fill(ctx.blocks_temp + longs, ctx.blocks_temp + count, 0);
+    unpack_longs(ctx.blocks_temp, &ctx.indices[y * SECTION_INDICES], count, n);
+}
+
+template <typename D>
+inline size_t index_at(Context<D> &ctx, const int y, const int b)
+{
+    // the palette index of one block, read straight from the packed longs, for sections that are not worth
+    // unpacking because only a few of their blocks are looked at
+    int n = index_bits(section_palette(ctx, y).size());
+    int d = 64 / n;
+    uint32_t l = b / d;
+    if (l >= ctx.longs[y])
+        return 0;
+    uint64_t word;
+    std::memcpy(&word, ctx.data[y] + static_cast<size_t>(l) * 8, 8);
+    return std::byteswap(word) >> (b % d * n) & ((1u << n) - 1);
+}
+
+template <typename D>
+inline uint8_t block_at(Context<D> &ctx, const int y, const int b)
+{
+    // the palette entry of one block, from its packed index, where indices past the end of the palette read
+    // the void it is padded with
+    size_t e = index_at(ctx, y, b);
+    return ctx.palette[y].data()[e];
+}
+
+template <typename D>
+inline void clear_chunk(Context<D> &ctx)
+{
+    // forget the sections and heightmap of the previous chunk
+    ctx.map_set = false;
+    std::memset(ctx.blocks_set, 0, D::SECTIONS);
+    std::memset(ctx.summarised, 0, D::SECTIONS);
+    std::memset(ctx.unpacked, 0, D::SECTIONS);
+    std::memset(ctx.decoded, 0, D::SECTIONS);
+    std::memset(ctx.palette_sizes, 0, sizeof(ctx.palette_sizes));
+    ctx.arena.reset();
+    ctx.id_arena.reset();
+}
+
+template <typename D>
+void parse(Context<D> &ctx)
+{
+    // mca chunk parser, but only reads the parts that are relevant to maps: Status, sections[].Y,
+    // sections[].block_states.{palette,data} and Heightmaps.WORLD_SURFACE. Chunks still being generated
+    // are left out, as the game does, and their sections are skipped if Status comes before them
+    if (*ctx.ptr++ != TAG_COMPOUND)
+        return;
+    read_string(ctx.ptr);
+    bool unfinished = false;
+    scan_compound(ctx.ptr, [&](uint8_t type, std::string_view name)
+                  {
+        if (type == TAG_STRING && name == "Status")
+        {
+            std::string_view status = read_string(ctx.ptr);
+            unfinished = status != "minecraft:full" && status != "full";
+            return true;
+        }
+        if (unfinished)
+            return false;
+        if (type == TAG_LIST && name == "sections" && *ctx.ptr == TAG_COMPOUND)
+        {
+            ctx.ptr++;
+            uint32_t n = read_u32(ctx.ptr);
+            while (n--)
+                parse_section(ctx);
+            return true;
+        }
+        if (type == TAG_COMPOUND && name == "Heightmaps")
+        {
+            scan_compound(ctx.ptr, [&](uint8_t type, std::string_view name)
+                          {
+                if (type == TAG_LONG_ARRAY && name == "WORLD_SURFACE")
+                {
+                    uint32_t n = read_u32(ctx.ptr);
+                    uint32_t kept = std::min<uint32_t>(n, D::HEIGHTMAP_LONGS);
+                    read_longs(ctx.ptr, ctx.heightmap, kept);
+                    ctx.ptr += static_cast<size_t>(n - kept) * 8;
+                    ctx.map_set = true;
+                    return true;
+                }
+                return false; });
+            return true;
+        }
+        return false; });
+    if (unfinished)
     {
-        if (prop & 32)
-            return colour & 255;
-        else
-            return colour >> 8;
+        ctx.stats.chunks_unfinished++;
+        clear_chunk(ctx);
+    }
+}
+
+template <typename D>
+inline void summarise_section(Context<D> &ctx, const int y)
+{
+    // per column bitmasks of a section, with a bit per block from the bottom up: visible blocks are the
+    // ones the search for the surface stops at (water or anything with a colour), and dry blocks are the
+    // ones that end a body of water. Sections made only of one kind of block skip the per block pass, and
+    // are never unpacked
+    std::span<const uint8_t> palette = section_palette(ctx, y);
+    uint8_t all = 3, any = 0;
+    for (size_t e = 0; e < palette.size(); e++)
+    {
+        uint8_t kind = ((palette[e] >> 6 & 1) || (palette[e] & 63)) | (palette[e] >> 6 ? 0 : 2);
+        ctx.kinds[e] = kind;
+        all &= kind;
+        any |= kind;
+    }
+    // indices past the end of the palette are void, which is dry
+    std::fill(ctx.kinds + palette.size(), ctx.kinds + (1 << index_bits(palette.size())), 2);
+    uint16_t *visible = &ctx.visible[y << 8];
+    uint16_t *dry = &ctx.dry[y << 8];
+    if (((all | ~any) & 3) == 3)
+    {
+        std::fill_n(visible, 256, all & 1 ? 0xFFFF : 0);
+        std::fill_n(dry, 256, all & 2 ? 0xFFFF : 0);
     }
     else
     {
-        return (check_water(name, prop) << 6) | (colour & 255);
+        unpack_section(ctx, y);
+        ctx.unpacked[y] = true;
+        std::fill_n(visible, 256, 0);
+        std::fill_n(dry, 256, 0);
+        const uint16_t *index = &ctx.indices[y * SECTION_INDICES];
+        for (int k = 0; k < 16; k++)
+            for (int col = 0; col < 256; col++)
+            {
+                uint8_t kind = ctx.kinds[*index++];
+                visible[col] |= (kind & 1) << k;
+                dry[col] |= (kind >> 1) << k;
+            }
     }
+    ctx.summarised[y] = true;
 }
 
-inline std::array<int, 3> get_state(const uint8_t d)
+template <typename D>
+inline int walk_column(Context<D> &ctx, const int col, int &h, int &depth, int &top)
 {
-    // Get the next state given the byte
-    std::array<int, 3> result;
-    std::copy_n(infos[d], 2, result.begin() + 1);
-    switch (d)
+    // find the colour of a column from the top of its heightmap, leaving top at the block found, h below
+    // the surface and depth set to the water above it, skipping a section at a time with the bitmasks of
+    // summarise_section
+    int c = 0;
+    // find the first block with a colour or water, a section at a time
+    while (h >= 0)
     {
-    case 8:
-        result[0] = 1;
-        break;
-    case 9:
-        result[0] = 4;
-        break;
-    case 10:
-        result[0] = 5;
+        ctx.stats.walk_steps++;
+        int h2 = h >> 4;
+        if (h2 >= D::SECTIONS)
+        {
+            h = (D::SECTIONS << 4) - 1;
+            continue;
+        }
+        if (!ctx.blocks_set[h2])
+        {
+            ctx.stats.palette_lookups++;
+            std::span<const uint8_t> palette = section_palette(ctx, h2);
+            c = palette.size() ? palette[0] & 63 : 0;
+            if (c)
+            {
+                top = h--;
+                break;
+            }
+            h = (h2 << 4) - 1;
+            continue;
+        }
+        if (!ctx.summarised[h2])
+            summarise_section(ctx, h2);
+        unsigned m = ctx.visible[(h2 << 8) + col] & ((2u << (h & 15)) - 1);
+        if (!m)
+        {
+            h = (h2 << 4) - 1;
+            continue;
+        }
+        h = (h2 << 4) + std::bit_width(m) - 1;
+        ctx.stats.palette_lookups++;
+        c = ctx.unpacked[h2] ? ctx.palette[h2].data()[ctx.indices[h2 * SECTION_INDICES + ((h & 15) << 8) + col]] : block_at(ctx, h2, ((h & 15) << 8) + col);
+        if (c >> 6 & 1)
+            depth = 1;
+        c = c & 63;
+        top = h--;
         break;
-    default:
-        if (d < 7)
-            result[0] = 2;
-        else
-            result[0] = 3;
+    }
+    // then count the water down to the first dry block, passing over sections without block data
+    while (depth && h >= 0)
+    {
+        ctx.stats.walk_steps++;
+        int h2 = h >> 4;
+        if (h2 >= D::SECTIONS || !ctx.blocks_set[h2])
+        {
+            h = std::min(h2, D::SECTIONS) * 16 - 1;
+            continue;
+        }
+        if (!ctx.summarised[h2])
+            summarise_section(ctx, h2);
+        unsigned m = ctx.dry[(h2 << 8) + col] & ((2u << (h & 15)) - 1);
+        if (!m)
+        {
+            depth += (h & 15) + 1;
+            h = (h2 << 4) - 1;
+            continue;
+        }
+        int top = (h2 << 4) + std::bit_width(m) - 1;
+        depth += h - top;
+        h = top - 1;
         break;
     }
-    return result;
+    return c;
 }
 
-void parse_none(uint32_t length, const std::array<int, 3> &state_info)
+template <typename D>
+inline int sample_column(Context<D> &ctx, const int col, int &h, int &depth, int &top)
 {
-    // Stripped parse for when the section is uninteresting
-    int next_state = 0;
-    int state;
-    std::array<uint8_t, 2> info;
-    bool sinfo_set;
-    if (state_info[0])
+    // the same walk as walk_column a block at a time, for scaled down maps, where so few columns of a
+    // section are looked at that unpacking and summarising it would cost more than the walk itself
+    int c = 0;
+    while (h >= 0)
     {
-        state = state_info[0];
-        std::copy_n(state_info.begin() + 1, 2, info.begin());
-        sinfo_set = true;
-    }
-    else
-    {
-        state = 0;
-        sinfo_set = false;
-    }
-    while (length--)
-    {
-        switch (state)
+        ctx.stats.walk_steps++;
+        int h2 = h >> 4;
+        if (h2 >= D::SECTIONS)
         {
-        case 0:
+            h = (D::SECTIONS << 4) - 1;
+            continue;
+        }
+        ctx.stats.palette_lookups++;
+        if (!ctx.blocks_set[h2])
         {
-            if (!(*ptr))
+            std::span<const uint8_t> palette = section_palette(ctx, h2);
+            c = palette.size() ? palette[0] & 63 : 0;
+            if (c)
             {
-                ptr++;
-                return;
+                top = h--;
+                break;
             }
-            std::array<int, 3> sinfo = get_state(*ptr);
-            ptr++;
-            next_state = sinfo[0];
-            std::copy_n(sinfo.begin() + 1, 2, info.begin());
-            state = 1;
-            break;
+            h = (h2 << 4) - 1;
+            continue;
         }
-        case 1:
-        {
-            uint16_t n;
-            std::memcpy(&n, ptr, 2);
-            n = std::byteswap(n);
-            ptr += 2;
-            if (!sinfo_set)
-                state = next_state;
-            if (next_state == 1)
-                next_state = 0;
-            ptr += n;
+        c = block_at(ctx, h2, ((h & 15) << 8) + col);
+        h--;
+        if ((c >> 6 & 1) || (c & 63))
+        {
+            top = h + 1;
+            depth = c >> 6 & 1;
+            c = c & 63;
             break;
         }
-        case 2:
-            if (!sinfo_set)
-                state = 0;
-            ptr += info[0];
-            break;
-        case 3:
-        {
-            uint32_t n;
-            std::memcpy(&n, ptr, 4);
-            n = std::byteswap(n);
-            ptr += 4 + n * info[1];
-            if (!sinfo_set)
-                state = 0;
-            break;
+        c = 0;
+    }
+    while (depth && h >= 0)
+    {
+        ctx.stats.walk_steps++;
+        int h2 = h >> 4;
+        if (h2 >= D::SECTIONS || !ctx.blocks_set[h2])
+        {
+            h = std::min(h2, D::SECTIONS) * 16 - 1;
+            continue;
         }
-        case 4:
-        {
-            std::array<int, 3> sinfo = get_state(*ptr);
-            ptr++;
-            uint32_t n;
-            std::memcpy(&n, ptr, 4);
-            n = std::byteswap(n);
-            ptr += 4;
-            parse_none(n, sinfo);
-            if (!sinfo_set)
-                state = 0;
+        ctx.stats.palette_lookups++;
+        bool dry = !(block_at(ctx, h2, ((h & 15) << 8) + col) >> 6);
+        h--;
+        if (dry)
             break;
-        }
-        case 5:
-            parse_none(-1, {0, 0, 0});
-            if (!sinfo_set)
-                state = 0;
+        depth++;
+    }
+    return c;
+}
+
+template <typename D>
+inline int under_roof(Context<D> &ctx, const int col)
+{
+    // the heightmap of a dimension with a ceiling only finds the ceiling, so its columns are walked from the
+    // first gap under it instead
+    int h = D::ROOF;
+    for (; h >= 0; h--)
+    {
+        int h2 = h >> 4;
+        std::span<const uint8_t> palette = section_palette(ctx, h2);
+        uint8_t p = ctx.blocks_set[h2] ? block_at(ctx, h2, ((h & 15) << 8) + col) : palette.size() ? palette[0] : 0;
+        if (!(p >> 6 & 1) && !(p & 63))
             break;
-        }
     }
+    return h;
 }
 
-void parse(uint32_t length, const std::array<int, 3> &state_info, std::string name)
+template <typename D>
+inline uint16_t block_id(Context<D> &ctx, const int y, const int col)
 {
-    // mca file parser, but only focuses on sections that are relevant to maps
-    int next_state = 0;
-    int state;
-    std::array<uint8_t, 2> info;
-    bool sinfo_set;
-    if (state_info[0])
+    // which block of colours.h is at height y of a column, once the walk has found it there
+    int h2 = y >> 4;
+    if (!ctx.blocks_set[h2])
+        return ctx.block_ids[h2][0];
+    int b = ((y & 15) << 8) + col;
+    return ctx.block_ids[h2][ctx.unpacked[h2] ? ctx.indices[h2 * SECTION_INDICES + b] : index_at(ctx, h2, b)];
+}
+
+template <typename D>
+inline bool create_colours(Context<D> &ctx, Tile &tile, const int shift = 0)
+{
+    // use the heightmap and parsed data to set the colours of a chunk, one pixel for every 1 << shift
+    // blocks along each side, taken from the block at the north west corner of each square
+    if (!ctx.map_set)
+        return false;
+    int n = 16 >> shift;
+    if (!shift)
+        unpack_longs(ctx.heightmap, ctx.heights, D::HEIGHTMAP_LONGS, D::HEIGHT_BITS);
+    for (int i = 0; i < n * n; i++)
     {
-        state = state_info[0];
-        std::copy_n(state_info.begin() + 1, 2, info.begin());
-        sinfo_set = true;
+        int x = i % n, z = i / n;
+        int col = (z << 4 | x) << shift;
+        constexpr int per_long = 64 / D::HEIGHT_BITS;
+        int h = shift ? ctx.heightmap[col / per_long] >> (col % per_long * D::HEIGHT_BITS) & ((1 << D::HEIGHT_BITS) - 1) : ctx.heights[col];
+        h--;
+        if (D::ROOF >= 0 && h >= D::ROOF)
+            h = under_roof(ctx, col);
+        int depth = 0, top = -1;
+        int c = shift ? sample_column(ctx, col, h, depth, top) : walk_column(ctx, col, h, depth, top);
+        tile.surface[i] = top + 1;
+        tile.depths[i] = depth ? std::min(top - h - 1, 255) : 0;
+        tile.blocks[i] = top >= 0 ? block_id(ctx, top, col) : 0;
+        uint8_t &pixel = tile.pixels[i];
+        if (depth)
+        {
+            h += depth - 1;
+            depth += ((x ^ z ^ 1) & 1) << 1;
+            if (depth < 5)
+                pixel = (2 << 6) | WATER_COLOUR;
+            else if (depth > 9)
+                pixel = WATER_COLOUR;
+            else
+                pixel = (1 << 6) | WATER_COLOUR;
+        }
+        else
+            pixel = UNSHADED | c;
+        tile.heights[i] = h;
     }
-    else
+    return true;
+}
+
+inline void blit(Framebuffer &frame, const Tile &tile, const int x, const int z, const int n = 16, uint64_t *counts = nullptr)
+{
+    // place a decoded chunk and its heights at pixel (x, z) of the image, to be shaded once the rows around
+    // it are done, cutting off whatever is outside the frame. The blocks of the pixels kept are added to
+    // counts, if given
+    int left = std::max(0, -x);
+    int right = std::min(n, static_cast<int>(frame.width) - x);
+    int top = std::max(0, static_cast<int>(frame.first) - z);
+    int bottom = std::min(n, static_cast<int>(frame.last) - z);
+    for (int r = top; r < bottom; r++)
+        for (int c = left; c < right;)
+        {
+            int run = std::min<int>(right - c, frame.run(x + c));
+            std::memcpy(frame.pixels(x + c, z + r), &tile.pixels[r * n + c], run);
+            std::memcpy(frame.heights(x + c, z + r), &tile.heights[r * n + c], run * 2);
+            if (frame.rasters)
+            {
+                std::memcpy(frame.surface(x + c, z + r), &tile.surface[r * n + c], run * 2);
+                std::memcpy(frame.depths(x + c, z + r), &tile.depths[r * n + c], run);
+            }
+            if (counts)
+                for (int i = r * n + c; i < r * n + c + run; i++)
+                    counts[tile.blocks[i]]++;
+            c += run;
+        }
+}
+
+template <typename D>
+void draw_region(Context<D> &ctx, const RegionFile &file, const std::array<int, 2> &region, const int bounds[4])
+{
+    // decode every chunk of a region inside bounds (the blocks the image covers, {west, east, north, south})
+    // and draw it, in any order since shading is left for shade_rows()
+    if (file.size < 8192)
+        return;
+    Job &job = ctx.job;
+    ctx.stats.bytes_read += 8192;
+    TileCache cache(job.rasters || job.count_blocks);
+    std::filesystem::path cache_path;
+    if (!job.cache_dir.empty())
     {
-        state = 0;
-        sinfo_set = false;
+        // scaled down maps and the other dimensions keep their own tiles, named after the scale and dimension
+        StageTimer timer(ctx.stats.read_time);
+        std::string suffix = job.dimension != OVERWORLD ? std::string(".") + DIMENSION_NAMES[job.dimension] : "";
+        if (job.scale_shift)
+            suffix += "." + std::to_string(1 << job.scale_shift);
+        cache_path = job.cache_dir / ("r." + std::to_string(region[0]) + "." + std::to_string(region[1]) + suffix + ".cache");
+        cache.load(cache_path.string());
     }
-    while (length--)
+    Tile tile;
+    uint64_t *counts = ctx.block_counts.empty() ? nullptr : ctx.block_counts.data();
+    // only the sectors of the chunks inside the bounds are ever touched, so a crop reads little more than the
+    // location table of each region
+    auto inside = [&](const int i)
     {
-        switch (state)
+        int x = ((region[0] << 5) + (i & 31)) << 4;
+        int z = ((region[1] << 5) + (i >> 5)) << 4;
+        return x + 15 >= bounds[0] && x <= bounds[1] && z + 15 >= bounds[2] && z <= bounds[3];
+    };
+    int next = 0;
+    while (next < 1024 && !inside(next))
+        next++;
+    if (next < 1024)
+        file.prefetch(file.location(next));
+    for (int i = next; i < 1024; i = next)
+    {
+        clear_chunk(ctx);
+        uint32_t loc = file.location(i);
+        do
+            next++;
+        while (next < 1024 && !inside(next));
+        if (next < 1024)
+            file.prefetch(file.location(next));
+        int n = 16 >> job.scale_shift;
+        int x = ((((region[0] << 5) + (i & 31)) << 4) - bounds[0]) >> job.scale_shift;
+        int z = ((((region[1] << 5) + (i >> 5)) << 4) - bounds[2]) >> job.scale_shift;
+        uint32_t timestamp = file.timestamp(i);
+        uint8_t state;
+        if (loc && !job.cache_dir.empty() && cache.find(i, timestamp, state, tile))
         {
-        case 0:
+            ctx.stats.chunks_cached++;
+            if (state == RENDERED)
+                blit(*job.frame, tile, x, z, n, counts);
+        }
+        else if (loc)
         {
-            if (!(*ptr))
+            size_t index = static_cast<size_t>(loc >> 8) << 12;
+            if (index + 5 > file.size)
             {
-                ptr++;
-                return;
+                ctx.stats.chunks_skipped++;
+                continue;
             }
-            std::array<int, 3> sinfo = get_state(*ptr);
-            ptr++;
-            next_state = sinfo[0];
-            std::copy_n(sinfo.begin() + 1, 2, info.begin());
-            state = 1;
-            break;
-        }
-        case 1:
-        {
-            uint16_t n;
-            std::memcpy(&n, ptr, 2);
-            n = std::byteswap(n);
-            ptr += 2;
-            if (!sinfo_set)
-                state = next_state;
-            if (next_state)
-                name.assign(reinterpret_cast<const char *>(ptr), n);
-            else
+            uint32_t length;
+            std::memcpy(&length, file.data + index, 4);
+            length = std::byteswap(length) - 1;
+            uint8_t type = file.data[index + 4];
+            index += 5;
+            const uint8_t *src = file.data + index;
+            if (type & EXTERNAL)
             {
-                if (interesting.contains(name))
-                {
-                    std::string item(reinterpret_cast<const char *>(ptr), n);
-                    if (name == "Name")
-                    {
-                        name_temp.resize(n - 10);
-                        name_temp = item.substr(10);
-                    }
-                    else if (prop_types.contains(name))
-                    {
-                        uint16_t n2;
-                        std::memcpy(&n2, &name[0], 2);
-                        switch (n2)
-                        {
-                        case 24951:
-                            if (item == "true")
-                                prop_temp |= 1;
-                            break;
-                        case 30817:
-                            if (item == "y")
-                                prop_temp |= 4;
-                            break;
-                        case 24944:
-                            if (item == "head")
-                                prop_temp |= 8;
-                            break;
-                        case 28783:
-                            if (item == "true")
-                                prop_temp |= 16;
-                            break;
-                        case 26465:
-                            if (std::stoi(item) >= 6)
-                                prop_temp |= 32;
-                            break;
-                        default:
-                            if (item == "bottom")
-                                prop_temp |= 2;
-                            break;
-                        }
-                    }
-                }
+                // kept next to the region file, so a region in memory has none
+                StageTimer timer(ctx.stats.read_time);
+                int chunk_x = (region[0] << 5) + (i & 31);
+                int chunk_z = (region[1] << 5) + (i >> 5);
+                std::filesystem::path path = std::filesystem::path(file.path).parent_path() / ("c." + std::to_string(chunk_x) + "." + std::to_string(chunk_z) + ".mcc");
+                const std::vector<uint8_t> *data = file.path.empty() ? nullptr : ctx.decompressor.read_file(path.string());
+                src = data ? data->data() : nullptr;
+                length = data ? data->size() : 0;
+                type &= ~EXTERNAL;
             }
-            ptr += n;
-            if (next_state == 1)
-                next_state = 0;
-            break;
-        }
-        case 2:
-            if (name == "Y")
+            else if (index + length > file.size)
+                src = nullptr;
+            ctx.ptr = nullptr;
+            if (src)
             {
-                std::memcpy(&y, ptr, info[0]);
-                y += 4;
+                StageTimer timer(ctx.stats.inflate_time);
+                ctx.ptr = ctx.decompressor.decompress(type, src, length);
             }
-            ptr += info[0];
-            if (!sinfo_set)
-                state = 0;
-            break;
-        case 3:
-        {
-            uint32_t n;
-            std::memcpy(&n, ptr, 4);
-            n = std::byteswap(n);
-            ptr += 4;
-            if (interesting.contains(name))
+            if (!ctx.ptr)
             {
-                if (name == "WORLD_SURFACE")
-                {
-                    map_set = true;
-                    for (int j = 0; j < n; j++)
-                    {
-                        std::memcpy(&heightmap[j], ptr, 8);
-                        ptr += 8;
-                        heightmap[j] = std::byteswap(heightmap[j]);
-                    }
-                }
-                else if (name == "data")
-                {
-                    if (n)
-                        b_temp_set = true;
-                    blocks_temp.resize(n);
-                    for (int j = 0; j < n; j++)
-                    {
-                        std::memcpy(&blocks_temp[j], ptr, 8);
-                        ptr += 8;
-                        blocks_temp[j] = std::byteswap(blocks_temp[j]);
-                    }
-                }
-                else
-                {
-                    std::array<int, 3> sinfo;
-                    std::copy_n(info.begin(), 2, sinfo.begin());
-                    sinfo[2] = 0;
-                    parse(n, sinfo, name);
-                }
+                file.release(loc);
+                ctx.stats.chunks_skipped++;
+                continue;
             }
-            else
-                ptr += n * info[1];
-            if (!sinfo_set)
-                state = 0;
-            break;
-        }
-        case 4:
-        {
-            std::array<int, 3> sinfo = get_state(*ptr);
-            ptr++;
-            uint32_t n;
-            std::memcpy(&n, ptr, 4);
-            n = std::byteswap(n);
-            ptr += 4;
-            if (interesting.contains(name))
-                parse(n, sinfo, name);
-            else
-                parse_none(n, sinfo);
-            if (!sinfo_set)
-                state = 0;
-            break;
-        }
-        case 5:
-            if (interesting.contains(name))
+            ctx.stats.bytes_read += length + 5;
+            ctx.stats.compressed_bytes += length;
+            ctx.stats.inflated_bytes += ctx.decompressor.size;
             {
-                if (name == "palette")
-                {
-                    parse(-1, {0, 0, 0}, name);
-                    palette_temp.push_back(process_name(name_temp, prop_temp));
-                    prop_temp = 0;
-                }
-                else if (name == "sections")
-                {
-                    parse(-1, {0, 0, 0}, name);
-                    if (y < 25)
-                    {
-                        std::swap(palette_temp, palette[y]);
-                        palette_temp.clear();
-                        std::swap(blocks_temp, blocks[y]);
-                        blocks_temp.clear();
-                        blocks_set[y] = b_temp_set;
-                        b_temp_set = false;
-                    }
-                }
-                else
-                    parse(-1, {0, 0, 0}, name);
+                StageTimer timer(ctx.stats.parse_time);
+                parse(ctx);
             }
-            else
-                parse_none(-1, {0, 0, 0});
-            if (!sinfo_set)
-                state = 0;
-            break;
+            ctx.stats.chunks_decoded++;
+            StageTimer timer(ctx.stats.render_time);
+            // sections are unpacked from the chunk's data as they are reached, so it is kept until here
+            bool rendered = create_colours(ctx, tile, job.scale_shift);
+            file.release(loc);
+            if (rendered)
+                blit(*job.frame, tile, x, z, n, counts);
+            if (!job.cache_dir.empty())
+                cache.store(i, timestamp, rendered ? RENDERED : EMPTY, tile);
         }
     }
+    if (cache.changed)
+        cache.save(cache_path.string());
 }
 
-inline void create_colours(std::vector<int> &heightline, const int &skip, const int &offset)
+template <typename D>
+void render_region(Context<D> &ctx, const std::array<int, 2> &region, const int bounds[4])
 {
-    // use the heightmap and parsed data to set the colours for the map
-    int i = 1;
-    if (!map_set)
+    // draw the region file of a region in the current directory
+    Clock::time_point start = Clock::now();
+    RegionFile file("r." + std::to_string(region[0]) + "." + std::to_string(region[1]) + ".mca");
+    ctx.stats.read_time += since(start);
+    draw_region(ctx, file, region, bounds);
+}
+
+inline void show_progress(Job &job, const int count, const size_t total, const uint64_t chunks)
+{
+    // report a finished region, with io_mutex held. The counter is redrawn at most ten times a second, or
+    // with --progress a line with the rate is printed every so many seconds instead
+    job.progress_chunks += chunks;
+    double elapsed = since(job.last_progress);
+    bool done = static_cast<size_t>(count) == total;
+    if (job.quiet || (elapsed < (job.progress_interval > 0 ? job.progress_interval : 0.1) && !done))
         return;
-    for (const auto &height : heightmap)
+    if (job.progress_interval > 0)
+        std::cout << "Processed: " << count << "/" << total << " regions, " << static_cast<uint64_t>(job.progress_chunks / elapsed) << " chunks/s" << std::endl;
+    else
+        std::cout << "\rProcessed: " << count << "/" << total << std::flush;
+    job.last_progress = Clock::now();
+    job.progress_chunks = 0;
+}
+
+template <typename D>
+void render_regions(Job &job, const std::vector<std::array<int, 2>> &regions, const size_t first, const size_t last, const int bounds[4], const int jobs, int &count)
+{
+    // decode regions [first, last) on a pool of workers
+    job.thread_stats.resize(std::max<size_t>(job.thread_stats.size(), jobs));
+    job.region_stats.resize(std::max(job.region_stats.size(), regions.size()));
+    if (job.count_blocks)
+        job.region_blocks.resize(std::max(job.region_blocks.size(), regions.size()));
+    std::atomic<size_t> next = first;
+    std::atomic<int> workers = 0;
+    auto work = [&]()
     {
-        int m = 0;
-        for (int j = 0; j < 7; j++)
+        Context<D> ctx(job);
+        if (job.count_blocks)
+            ctx.block_counts.assign(BLOCK_COUNT, 0);
+        int id = workers++;
+        size_t r;
+        while ((r = next++) < last)
         {
-            if (i > 256)
-                break;
-            int h = (height >> m) & 511;
-            h--;
-            int c = 0;
-            int depth = 0;
-            while (!c || depth)
+            next.notify_all();
+            uint64_t before = ctx.stats.chunks_decoded + ctx.stats.chunks_cached;
+            Clock::time_point start = Clock::now();
+            render_region(ctx, regions[r], bounds);
+            job.region_stats[r] = {regions[r][0], regions[r][1], ctx.stats.chunks_decoded + ctx.stats.chunks_cached - before, since(start)};
+            if (job.count_blocks)
             {
-                if (h < 0)
-                    break;
-                int h2 = h >> 4;
-                if (!blocks_set[h2])
-                {
-                    if (palette[h2].size())
-                        c = palette[h2][0] & 63;
-                    else
-                        c = 0;
-                    h--;
-                    continue;
-                }
-                int index = ((h & 15) << 8) + i;
-                int n = std::max(4, std::bit_width<unsigned>(palette[h2].size() - 1));
-                int d = 64 / n;
-                int index2 = (index + d - 1) / d - 1;
-                int shift = ((index % d) - 1) * n;
-                if (shift < 0)
-                    shift = n * (d - 1);
-                index = (blocks[h2][index2] >> shift) & ((1 << n) - 1);
-                c = palette[h2][index];
-                int f = c >> 6;
-                c = c & 63;
-                h--;
-                if (f)
-                {
-                    if (depth)
-                        depth++;
-                    else if (f & 1)
-                        depth = 1;
-                }
-                else if (depth)
-                    break;
+                job.region_blocks[r] = std::move(ctx.block_counts);
+                ctx.block_counts.assign(BLOCK_COUNT, 0);
             }
-            int w = skip + ((i - 1) & 15);
-            int z = offset + ((i - 1) >> 4);
-            if (depth)
+            job.band_tracker.done(regions[r][1] - (bounds[2] >> 9));
+            std::lock_guard<std::mutex> lock(job.io_mutex);
+            show_progress(job, ++count, regions.size(), job.region_stats[r].chunks);
+        }
+        next.notify_all();
+        job.thread_stats[id] += ctx.stats;
+    };
+    auto prefetch = [&]()
+    {
+        // have the files of the next few regions read while the workers are busy with the ones before them,
+        // staying no more than one region per worker ahead. Regions only partly inside a crop are left to
+        // read just the chunks they need
+        size_t ahead = first;
+        size_t n;
+        while ((n = next) < last)
+        {
+            ahead = std::max(ahead, n);
+            if (ahead < std::min(last, n + jobs))
             {
-                h += depth - 1;
-                depth += (((i - 1 >> 4) ^ i) & 1) << 1;
-                if (depth < 5)
-                    output[z][w] = (2 << 6) | (COLOURS.at("water") & 255);
-                else if (depth > 9)
-                    output[z][w] = (COLOURS.at("water") & 255);
-                else
-                    output[z][w] = (1 << 6) | (COLOURS.at("water") & 255);
+                const std::array<int, 2> &region = regions[ahead++];
+                if (region[0] << 9 >= bounds[0] && (region[0] << 9) + 511 <= bounds[1] && region[1] << 9 >= bounds[2] && (region[1] << 9) + 511 <= bounds[3])
+                    prefetch_file("r." + std::to_string(region[0]) + "." + std::to_string(region[1]) + ".mca");
             }
-            else if (h < heightline[w])
-                output[z][w] = c;
-            else if (h == heightline[w])
-                output[z][w] = (1 << 6) | c;
             else
-                output[z][w] = (2 << 6) | c;
-            heightline[w] = h;
-            i++;
-            m += 9;
+                next.wait(n);
         }
-    }
+    };
+    std::thread prefetcher(prefetch);
+    std::vector<std::thread> pool;
+    for (int t = 1; t < jobs; t++)
+        pool.emplace_back(work);
+    work();
+    for (auto &thread : pool)
+        thread.join();
+    prefetcher.join();
 }
 
-inline void write_file(std::vector<std::vector<uint8_t>> &data)
+void render_dimension(Job &job, const std::vector<std::array<int, 2>> &regions, const size_t first, const size_t last, const int bounds[4], const int jobs, int &count)
 {
-    // compresses and writes the png file
-    std::ofstream file;
-    file.open("output.png", std::ios::binary);
-    file.write(reinterpret_cast<char *>(FORMAT.data()), FORMAT.size());
-    file.close();
-
-    file.open("output.png", std::ios::binary | std::ios::app);
-    uint32_t space = 1;
-    std::vector<uint8_t> data2(space);
-    z_stream strm{};
-    size_t index = 0;
-    size_t block_num = data.size() - 1;
-    size_t block_size = data[0].size();
-    strm.next_in = &data[0][0];
-    strm.avail_in = block_size;
-    deflateInit(&strm, 9);
-    bool ended = false;
-    bool flushing = false;
-    while (true)
+    // render with the decoder specialised for the dimension being drawn
+    switch (job.dimension)
     {
-        uint32_t zindex = 0;
-        uint32_t have = space;
-        strm.next_out = &data2[0];
-        strm.avail_out = space;
+    case NETHER:
+        render_regions<Nether>(job, regions, first, last, bounds, jobs, count);
+        break;
+    case END:
+        render_regions<End>(job, regions, first, last, bounds, jobs, count);
+        break;
+    default:
+        render_regions<Overworld>(job, regions, first, last, bounds, jobs, count);
+        break;
+    }
+}
 
-        while (true)
+void shade_rows(Job &job, std::vector<int16_t> &north, const size_t first, const size_t last, const int jobs)
+{
+    // the second pass: shade each row of the frame in [first, last) against the row before it, and the first
+    // against north, which is left holding the heights of the last row for the band after it. Every row only
+    // reads heights, so the rows are split between workers in any order
+    Framebuffer &frame = *job.frame;
+    std::vector<int16_t> missing(frame.width, NO_HEIGHT);
+    std::atomic<size_t> next = first;
+    auto work = [&]()
+    {
+        size_t r;
+        while ((r = next++) < last)
         {
-            if (flushing)
+            if (!frame.used(r))
+                continue;
+            for (uint32_t x = 0; x < frame.width; x += frame.run(x))
             {
-                if (deflate(&strm, Z_FINISH) == Z_STREAM_END)
-                {
-                    ended = true;
-                    break;
-                }
+                const int16_t *above = r == first ? &north[x] : frame.used(r - 1) ? frame.heights(x, r - 1) : &missing[x];
+                shade_row(frame.pixels(x, r), frame.heights(x, r), above, frame.run(x));
             }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < jobs; t++)
+        pool.emplace_back(work);
+    work();
+    for (auto &thread : pool)
+        thread.join();
+    if (!frame.used(last - 1))
+        north = missing;
+    else
+        for (uint32_t x = 0; x < frame.width; x += frame.run(x))
+            std::copy_n(frame.heights(x, last - 1), frame.run(x), &north[x]);
+}
+
+std::vector<bool> find_chunk_rows(const std::vector<std::array<int, 2>> &regions, const int bounds[4])
+{
+    // which chunk rows of the image have any chunks inside the bounds in them, from the location tables of
+    // the regions, so that the empty parts of a sparse world take no memory and are written as precomputed
+    // empty rows
+    std::vector<bool> rows((bounds[3] >> 4) - (bounds[2] >> 4) + 1);
+    for (const auto &region : regions)
+    {
+        std::ifstream file("r." + std::to_string(region[0]) + "." + std::to_string(region[1]) + ".mca", std::ios::binary);
+        uint32_t table[1024];
+        if (!file.read(reinterpret_cast<char *>(table), 4096))
+            continue;
+        for (int i = 0; i < 1024; i++)
+        {
+            int x = (region[0] << 5) + (i & 31);
+            int z = (region[1] << 5) + (i >> 5);
+            if (table[i] && x >= bounds[0] >> 4 && x <= bounds[1] >> 4 && z >= bounds[2] >> 4 && z <= bounds[3] >> 4)
+                rows[z - (bounds[2] >> 4)] = true;
+        }
+    }
+    return rows;
+}
+
+inline std::shared_ptr<Framebuffer> make_frame(const Job &job, const uint32_t width, const int bounds[4], const size_t first, const size_t last)
+{
+    // a frame for rows [first, last) of the image of the blocks in bounds, whose squares with TILES are
+    // the regions
+    int tile = 512 >> job.scale_shift;
+    int x_offset = (bounds[0] & 511) >> job.scale_shift;
+    int z_offset = ((bounds[2] + static_cast<int>(first << job.scale_shift)) & 511) >> job.scale_shift;
+    return std::make_shared<Framebuffer>(width, first, last, job.layout, tile, x_offset, z_offset, job.rasters);
+}
+
+inline void allocate_rows(Job &job, const std::vector<bool> &chunk_rows, const int bounds[4], const size_t first, const size_t last)
+{
+    // ready the rows of the frame in [first, last) that chunks will be drawn on, and leave the rest unused,
+    // so that they are never touched and take no memory
+    for (size_t r = first; r < last; r++)
+        if (chunk_rows[((bounds[2] + static_cast<int>(r << job.scale_shift)) >> 4) - (bounds[2] >> 4)])
+            job.frame->use(r);
+}
+
+template <typename D>
+void draw_row(Job &job, const int bounds[4])
+{
+    // draw the regions a single row of pixels crosses, on this thread
+    Context<D> ctx(job);
+    for (int x = bounds[0] >> 9; x <= bounds[1] >> 9; x++)
+        render_region(ctx, {x, bounds[2] >> 9}, bounds);
+}
+
+std::vector<int16_t> north_of(Job &job, const uint32_t width, const int bounds[4])
+{
+    // the heights of the row of pixels just north of bounds, drawn from the chunk row it is in, so that the
+    // first row of a crop is shaded as it is in the full map
+    int z = bounds[2] - (1 << job.scale_shift);
+    const int row[4] = {bounds[0], bounds[1], z, z};
+    job.frame = make_frame(job, width, row, 0, 1);
+    job.frame->use(0);
+    switch (job.dimension)
+    {
+    case NETHER:
+        draw_row<Nether>(job, row);
+        break;
+    case END:
+        draw_row<End>(job, row);
+        break;
+    default:
+        draw_row<Overworld>(job, row);
+        break;
+    }
+    std::vector<int16_t> north(width);
+    for (uint32_t x = 0; x < width; x += job.frame->run(x))
+        std::copy_n(job.frame->heights(x, 0), job.frame->run(x), &north[x]);
+    job.frame.reset();
+    return north;
+}
+
+struct mcmap_renderer
+{
+    // a Job of its own and the one worker's Context for its dimension
+    Job job;
+    std::unique_ptr<Context<Overworld>> overworld;
+    std::unique_ptr<Context<Nether>> nether;
+    std::unique_ptr<Context<End>> end;
+};
+
+template <typename F>
+int with_context(mcmap_renderer &renderer, F &&f)
+{
+    // call f with the renderer's Context, and keep exceptions from crossing the C interface
+    try
+    {
+        switch (renderer.job.dimension)
+        {
+        case NETHER:
+            return f(*renderer.nether);
+        case END:
+            return f(*renderer.end);
+        default:
+            return f(*renderer.overworld);
+        }
+    }
+    catch (...)
+    {
+        return MCMAP_FAILED;
+    }
+}
+
+template <typename D>
+int render_chunk(Context<D> &ctx, const uint8_t *data, const size_t size, const uint8_t compression, const int16_t *north, uint8_t *pixels, const size_t stride, int16_t *heights)
+{
+    // decode and draw a chunk on its own, shading it within itself and against the row north of it
+    clear_chunk(ctx);
+    ctx.ptr = ctx.decompressor.decompress(compression, data, size);
+    if (!ctx.ptr)
+        return MCMAP_INVALID;
+    parse(ctx);
+    Tile tile;
+    if (!create_colours(ctx, tile, ctx.job.scale_shift))
+        return MCMAP_EMPTY;
+    int n = 16 >> ctx.job.scale_shift;
+    int16_t missing[16];
+    std::fill_n(missing, 16, NO_HEIGHT);
+    for (int z = 0; z < n; z++)
+    {
+        uint8_t *row = pixels + z * stride;
+        std::memcpy(row, &tile.pixels[z * n], n);
+        shade_row(row, &tile.heights[z * n], z ? &tile.heights[(z - 1) * n] : north ? north : missing, n);
+    }
+    if (heights)
+        std::memcpy(heights, tile.heights, n * n * 2);
+    return MCMAP_OK;
+}
+
+extern "C"
+{
+    int mcmap_api_version(void)
+    {
+        return MCMAP_API_VERSION;
+    }
+
+    int mcmap_palette(uint8_t *rgb)
+    {
+        // the PLTE chunk of the header in format.h
+        uint32_t length;
+        std::memcpy(&length, &FORMAT[33], 4);
+        int colours = std::min<uint32_t>(std::byteswap(length) / 3, 256);
+        std::memcpy(rgb, &FORMAT[41], colours * 3);
+        return colours;
+    }
+
+    mcmap_renderer *mcmap_renderer_new(const int dimension, const int scale)
+    {
+        if (dimension < MCMAP_OVERWORLD || dimension > MCMAP_END || scale < 1 || scale > 16 || !std::has_single_bit(static_cast<unsigned>(scale)))
+            return nullptr;
+        try
+        {
+            auto renderer = std::make_unique<mcmap_renderer>();
+            renderer->job.dimension = static_cast<Dimension>(dimension);
+            renderer->job.scale_shift = std::countr_zero(static_cast<unsigned>(scale));
+            renderer->job.quiet = true;
+            if (dimension == MCMAP_NETHER)
+                renderer->nether = std::make_unique<Context<Nether>>(renderer->job);
+            else if (dimension == MCMAP_END)
+                renderer->end = std::make_unique<Context<End>>(renderer->job);
             else
-                deflate(&strm, Z_NO_FLUSH);
-            if (!strm.avail_out)
+                renderer->overworld = std::make_unique<Context<Overworld>>(renderer->job);
+            return renderer.release();
+        }
+        catch (...)
+        {
+            return nullptr;
+        }
+    }
+
+    void mcmap_renderer_free(mcmap_renderer *renderer)
+    {
+        delete renderer;
+    }
+
+    int mcmap_render_chunk(mcmap_renderer *renderer, const uint8_t *data, const size_t size, const int compression, const int16_t *north, uint8_t *pixels, const size_t stride, int16_t *heights)
+    {
+        if (!renderer || !data || !pixels || compression < GZIP || compression > LZ4)
+            return MCMAP_INVALID;
+        return with_context(*renderer, [&](auto &ctx)
+                            { return render_chunk(ctx, data, size, static_cast<uint8_t>(compression), north, pixels, stride, heights); });
+    }
+
+    int mcmap_render_region(mcmap_renderer *renderer, const uint8_t *data, const size_t size, uint8_t *pixels, const size_t stride)
+    {
+        // drawn on the Job's rows like any other region, then copied out once shaded
+        if (!renderer || !data || !pixels || size < 8192)
+            return MCMAP_INVALID;
+        Job &job = renderer->job;
+        int n = 512 >> job.scale_shift;
+        return with_context(*renderer, [&](auto &ctx)
+                            {
+            const int bounds[4] = {0, 511, 0, 511};
+            job.frame = make_frame(job, n, bounds, 0, n);
+            for (int z = 0; z < n; z++)
+                job.frame->use(z);
+            draw_region(ctx, RegionFile(data, size), {0, 0}, bounds);
+            std::vector<int16_t> north(n, NO_HEIGHT);
+            shade_rows(job, north, 0, n, 1);
+            for (int z = 0; z < n; z++)
+                job.frame->scanline(z, pixels + z * stride);
+            job.frame.reset();
+            return MCMAP_OK; });
+    }
+
+    int mcmap_encode_png(const uint8_t *pixels, const uint32_t width, const uint32_t height, const size_t stride, const int level, uint8_t **png, size_t *size)
+    {
+        if (!pixels || !png || !size || !width || !height || stride < width || level < 0 || level > 9)
+            return MCMAP_INVALID;
+        try
+        {
+            // a band of scanlines at a time, with rows of nothing left empty for the writer's shortcut
+            std::ostringstream stream;
+            PngWriter writer(stream, width, height, level);
+            for (uint32_t first = 0; first < height; first += 256)
             {
-                if (space < 4294967295)
+                std::vector<std::vector<uint8_t>> rows(std::min<uint32_t>(256, height - first));
+                for (size_t r = 0; r < rows.size(); r++)
                 {
-                    zindex = space - strm.avail_out;
-                    have = space + strm.avail_out;
-                    if (space == 2147483648)
+                    const uint8_t *row = pixels + (first + r) * stride;
+                    if (std::any_of(row, row + width, [](uint8_t p) { return p; }))
                     {
-                        space = 4294967295;
-                        have--;
+                        rows[r].resize(width + 1);
+                        std::memcpy(rows[r].data() + 1, row, width);
                     }
-                    else
-                        space <<= 1;
-                    data2.resize(space);
-                    strm.next_out = &data2[zindex];
-                    strm.avail_out = have;
-                }
-                else
-                    break;
-            }
-            else if (!strm.avail_in)
-            {
-                if (index < block_num)
-                {
-                    strm.next_in = &data[++index][0];
-                    strm.avail_in = block_size;
                 }
-                else
-                    flushing = true;
+                writer.write(rows);
             }
+            writer.finish();
+            std::string bytes = std::move(stream).str();
+            *png = static_cast<uint8_t *>(std::malloc(bytes.size()));
+            if (!*png)
+                return MCMAP_FAILED;
+            std::memcpy(*png, bytes.data(), bytes.size());
+            *size = bytes.size();
+            return MCMAP_OK;
         }
-        uint32_t size = data2.size() - strm.avail_out;
-        uint32_t size2 = std::byteswap(size);
-
-        file.write(reinterpret_cast<char *>(&size2), 4);
-        uint32_t crc = crc32(0L, Z_NULL, 0);
-        file.write("IDAT", 4);
-        crc = crc32(crc, reinterpret_cast<const Bytef *>("IDAT"), 4);
-        file.write(reinterpret_cast<char *>(data2.data()), size);
-        crc = crc32(crc, reinterpret_cast<const Bytef *>(data2.data()), size);
-        crc = std::byteswap(crc);
-        file.write(reinterpret_cast<char *>(&crc), 4);
-        if (ended)
-            break;
+        catch (...)
+        {
+            return MCMAP_FAILED;
+        }
+    }
+
+    void mcmap_free(void *memory)
+    {
+        std::free(memory);
     }
-    inflateEnd(&strm);
-    file.write("\0\0\0\0IEND\xae\x42\x60\x82", 12);
-    file.close();
 }
 
-int main()
+inline int convert_raw(const std::string &path, const std::filesystem::path &tile_dir, const int tile_size, const int level, const int threads)
 {
+    // encode a raw map written by an earlier run as output.png or tiles, a row of its tiles at a time
+    RawMap raw(path);
+    if (!raw.valid())
+    {
+        std::cerr << "Not a raw map: " << path << "\n";
+        return 1;
+    }
+    std::cout << "Converting a " << raw.width << " by " << raw.height << " map...\n";
+    std::unique_ptr<PngWriter> png;
+    std::unique_ptr<TileWriter> tiles;
+    if (tile_dir.empty())
+        png = std::make_unique<PngWriter>("output.png", raw.width, raw.height, level, threads);
+    else
+        tiles = std::make_unique<TileWriter>(tile_dir, tile_size, raw.width, raw.height, level, threads);
+    for (uint32_t first = 0; first < raw.height; first += raw.tile_size)
+    {
+        std::vector<std::vector<uint8_t>> rows = raw.scanlines(first, std::min(raw.height, first + raw.tile_size));
+        if (png)
+            png->write(rows);
+        else
+            tiles->write(rows);
+    }
+    if (png)
+        png->finish();
+    else
+        tiles->finish();
+    std::cout << "Done.\n";
+    return 0;
+}
+
+struct RunOptions
+{
+    // how the command line asks for a world to be rendered and written out, besides what goes in the Job
+    int jobs = std::max(1u, std::thread::hardware_concurrency());
+    int deflate_threads = 0;
+    int level = 9;
+    bool stream = false;
+    std::filesystem::path tile_dir;
+    int tile_size = 256;
+    std::string report_path;
+    std::string raw_path;
+    std::string heights_path;
+    std::string water_path;
+    std::string blocks_path;
+    bool write_png = true;
+    bool cropped = false;
+    int crop[4];
+};
+
+int render_world(Job &job, const RunOptions &options)
+{
+    // render the region files in the current directory and write the image out
+    if (!job.cache_dir.empty())
+        std::filesystem::create_directories(job.cache_dir);
     std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
     std::cout << "Collecting region files...\n";
     std::vector<std::array<int, 2>> regions;
@@ -597,148 +1295,321 @@ int main()
     bool initial = false;
     int num_regions = 0;
     std::cout << "Collected: " << num_regions;
-    for (const auto &entry : std::filesystem::directory_iterator(std::filesystem::current_path()))
+    if (options.cropped)
     {
-        if (entry.is_regular_file())
+        // only the regions the crop touches, found by name rather than by listing the folder
+        for (int z = options.crop[2] >> 9; z <= options.crop[3] >> 9; z++)
+            for (int x = options.crop[0] >> 9; x <= options.crop[1] >> 9; x++)
+                if (std::filesystem::is_regular_file("r." + std::to_string(x) + "." + std::to_string(z) + ".mca"))
+                {
+                    regions.push_back({x, z});
+                    std::cout << "\rCollected: " << ++num_regions << std::flush;
+                }
+        std::copy_n(options.crop, 4, bounds);
+    }
+    else
+    {
+        for (const auto &entry : std::filesystem::directory_iterator(std::filesystem::current_path()))
         {
-            std::string file_name = entry.path().filename().string();
-            if (!file_name.ends_with(".mca"))
-                continue;
-            std::istringstream ss(file_name);
-            std::array<int, 2> parts;
-            std::string token;
-
-            int i = 0;
-            while (std::getline(ss, token, '.'))
+            if (entry.is_regular_file())
             {
-                if (i && i < 3)
+                std::string file_name = entry.path().filename().string();
+                if (!file_name.ends_with(".mca"))
+                    continue;
+                std::istringstream ss(file_name);
+                std::array<int, 2> parts;
+                std::string token;
+
+                int i = 0;
+                while (std::getline(ss, token, '.'))
                 {
-                    int value = std::stoi(token);
-                    if (i == 1)
-                    {
-                        if (initial)
-                        {
-                            bounds[0] = std::min(bounds[0], value);
-                            bounds[1] = std::max(bounds[1], value);
-                        }
-                        else
-                        {
-                            bounds[0] = value;
-                            bounds[1] = value;
-                        }
-                    }
-                    else
+                    if (i && i < 3)
                     {
-                        if (initial)
+                        int value = std::stoi(token);
+                        if (i == 1)
                         {
-                            bounds[2] = std::min(bounds[2], value);
-                            bounds[3] = std::max(bounds[3], value);
+                            if (initial)
+                            {
+                                bounds[0] = std::min(bounds[0], value);
+                                bounds[1] = std::max(bounds[1], value);
+                            }
+                            else
+                            {
+                                bounds[0] = value;
+                                bounds[1] = value;
+                            }
                         }
                         else
                         {
-                            bounds[2] = value;
-                            bounds[3] = value;
-                            initial = true;
+                            if (initial)
+                            {
+                                bounds[2] = std::min(bounds[2], value);
+                                bounds[3] = std::max(bounds[3], value);
+                            }
+                            else
+                            {
+                                bounds[2] = value;
+                                bounds[3] = value;
+                                initial = true;
+                            }
                         }
+                        parts[i - 1] = std::stoi(token);
                     }
-                    parts[i - 1] = std::stoi(token);
+                    i++;
                 }
-                i++;
+                regions.push_back(parts);
+                std::cout << "\rCollected: " << ++num_regions << std::flush;
             }
-            regions.push_back(parts);
-            std::cout << "\rCollected: " << ++num_regions << std::flush;
         }
+        // from the regions to the blocks they cover
+        bounds[0] <<= 9;
+        bounds[1] = (bounds[1] << 9) + 511;
+        bounds[2] <<= 9;
+        bounds[3] = (bounds[3] << 9) + 511;
     }
 
     std::sort(regions.begin(), regions.end(), [](const std::array<int, 2> &a, const std::array<int, 2> &b) {
         if (a[1] == b[1])
             return a[0] < b[0];
         return a[1] < b[1]; });
-    int rangex = bounds[1] - bounds[0] + 1;
-    int rangez = bounds[3] - bounds[2] + 1;
+    // a scaled down image starts on a whole pixel, and the bands of output rows are the rows of regions
+    bounds[0] &= ~((1 << job.scale_shift) - 1);
+    bounds[1] |= (1 << job.scale_shift) - 1;
+    bounds[2] &= ~((1 << job.scale_shift) - 1);
+    bounds[3] |= (1 << job.scale_shift) - 1;
+    int rangez = (bounds[3] >> 9) - (bounds[2] >> 9) + 1;
+    auto band_range = [&](const int b)
+    {
+        int top = std::max(bounds[2], ((bounds[2] >> 9) + b) << 9);
+        int bottom = std::min(bounds[3], (((bounds[2] >> 9) + b) << 9) + 511);
+        return std::array<size_t, 2>{static_cast<size_t>((top - bounds[2]) >> job.scale_shift), static_cast<size_t>(((bottom - bounds[2]) >> job.scale_shift) + 1)};
+    };
 
-    // Setting up png file header
-    uint32_t width = rangex << 9;
-    uint32_t height = rangez << 9;
+    uint32_t width = ((bounds[1] - bounds[0]) >> job.scale_shift) + 1;
+    uint32_t height = ((bounds[3] - bounds[2]) >> job.scale_shift) + 1;
     uint64_t image_size = static_cast<uint64_t>(width) * height;
-    width = std::byteswap(width);
-    height = std::byteswap(height);
-    std::memcpy(&FORMAT[16], &width, 4);
-    std::memcpy(&FORMAT[20], &height, 4);
-
-    uint32_t crc = crc32(0L, Z_NULL, 0);
-    crc = crc32(crc, reinterpret_cast<const Bytef *>(&FORMAT[12]), 17);
-    crc = std::byteswap(crc);
-    std::memcpy(&FORMAT[29], &crc, 4);
-
-    std::vector<int> heightline(512 * rangex + 1, -1);
+    std::vector<int16_t> north = options.cropped ? north_of(job, width, bounds) : std::vector<int16_t>(width, NO_HEIGHT);
     std::cout << "\nOutput image size will be " << image_size << " pixels.\n";
-    output.resize((rangez << 9), std::vector<uint8_t>((rangex << 9) + 1));
+    std::vector<bool> chunk_rows = find_chunk_rows(regions, bounds);
+    if (!options.stream)
+    {
+        job.frame = make_frame(job, width, bounds, 0, height);
+        allocate_rows(job, chunk_rows, bounds, 0, height);
+    }
+    std::vector<int> band_regions(rangez);
+    for (const auto &region : regions)
+        band_regions[region[1] - (bounds[2] >> 9)]++;
+    job.band_tracker.reset(band_regions);
 
     std::cout << "Processing region files...\n";
-    std::vector<uint8_t> chunk;
+    std::unique_ptr<PngWriter> png;
+    std::unique_ptr<TileWriter> tiles;
+    std::unique_ptr<RawWriter> raw;
+    std::unique_ptr<RasterWriter<uint16_t>> heights;
+    std::unique_ptr<RasterWriter<uint8_t>> water;
+    int deflate_threads = options.deflate_threads ? options.deflate_threads : options.jobs;
+    if (options.write_png && options.tile_dir.empty())
+        png = std::make_unique<PngWriter>("output.png", width, height, options.level, deflate_threads);
+    else if (options.write_png)
+        tiles = std::make_unique<TileWriter>(options.tile_dir, options.tile_size, width, height, options.level, deflate_threads);
+    if (!options.raw_path.empty())
+        raw = std::make_unique<RawWriter>(options.raw_path, width, height, bounds[0], bounds[2], 1 << job.scale_shift);
+    if (!options.heights_path.empty())
+        heights = std::make_unique<RasterWriter<uint16_t>>(options.heights_path, width, height, options.level, deflate_threads);
+    if (!options.water_path.empty())
+        water = std::make_unique<RasterWriter<uint8_t>>(options.water_path, width, height, options.level, deflate_threads);
     int count = 0;
-    int space = 1;
-    std::vector<uint8_t> chunk2(space);
-    for (const auto &region : regions)
+    Stats main_stats;
+    job.last_progress = Clock::now();
+    // finished bands are compressed on their own thread while the next ones are rendered, with at most two
+    // waiting for it before rendering has to wait in turn. The writer gives the memory of each band back
+    // once it is written
+    struct Band
     {
-        std::cout << "\rProcessed: " << ++count << "/" << num_regions << std::flush;
-        std::ostringstream oss;
-        oss << "r." << region[0] << "." << region[1] << ".mca";
-        std::ifstream file(oss.str(), std::ios::binary);
-        file.seekg(0, std::ios::end);
-        size_t file_size = file.tellg();
-        if (file_size == 0)
-            continue;
-        file.seekg(0, std::ios::beg);
-        std::vector<uint8_t> data(file_size);
-        file.read(reinterpret_cast<char *>(&data[0]), file_size);
-        file.close();
-        for (int i = 0; i < 1024; i++)
+        std::shared_ptr<Framebuffer> frame;
+        size_t first;
+        size_t last;
+    };
+    BoundedQueue<Band> bands(2);
+    std::thread writer([&]()
+                       {
+        Band band;
+        std::vector<uint8_t> scratch;
+        std::vector<uint16_t> surface_scratch;
+        while (bands.pop(band))
         {
-            map_set = false;
-            std::memset(blocks_set, 0, 25);
-            int i2 = ((i >> 5) << 7) + ((i & 31) << 2);
-            uint32_t index;
-            std::memcpy(&index, data.data() + i2, 4);
-            index = std::byteswap(index);
-            if (index)
-            {
-                index = (index >> 8) << 12;
-                uint32_t length;
-                std::memcpy(&length, data.data() + index, 4);
-                length = std::byteswap(length) - 1;
-                index += 5;
-                if (length > chunk.size())
-                    chunk.resize(1 << std::bit_width<unsigned>(length));
-                std::vector<uint8_t> chunk(length);
-                std::memcpy(&chunk[0], data.data() + index, length);
-                z_stream strm{};
-                strm.next_in = chunk.data();
-                strm.avail_in = length;
-                inflateInit(&strm);
-                int zindex = 0;
-                int have = space;
-                while (true)
-                {
-                    strm.next_out = &chunk2[zindex];
-                    strm.avail_out = have;
-                    if (inflate(&strm, Z_NO_FLUSH) == Z_STREAM_END)
-                        break;
-                    zindex = space - strm.avail_out;
-                    have = space + strm.avail_out;
-                    space <<= 1;
-                    chunk2.resize(space);
-                }
-                inflateEnd(&strm);
-                ptr = &chunk2[3];
-                parse(1, {5, 0, 0}, "Y");
-                create_colours(heightline, ((region[0] - bounds[0]) << 9) + ((i & 31) << 4) + 1, ((region[1] - bounds[2]) << 9) + ((i >> 5) << 4));
-            }
+            StageTimer timer(main_stats.deflate_time);
+            std::vector<const uint8_t *> rows = band.frame->scanlines(band.first, band.last, scratch);
+            if (raw)
+                raw->write(rows);
+            if (png)
+                png->write(rows);
+            else if (tiles)
+                tiles->write(rows);
+            if (heights)
+                heights->write(band.frame->surface_rows(band.first, band.last, surface_scratch));
+            if (water)
+                water->write(band.frame->depth_rows(band.first, band.last, scratch));
+            band.frame->release(band.first, band.last);
+            band.frame.reset();
+        } });
+    auto send = [&](const int band)
+    {
+        // shade a band once all its regions are drawn and hand it over
+        auto [first, last] = band_range(band);
+        {
+            StageTimer timer(main_stats.render_time);
+            shade_rows(job, north, first, last, options.jobs);
         }
+        bands.push({job.frame, first, last});
+    };
+    if (options.stream)
+    {
+        // render one band of regions at a time, so that only the bands being rendered and compressed take
+        // memory
+        size_t first = 0;
+        for (int b = 0; b < rangez; b++)
+        {
+            size_t last = first;
+            while (last < regions.size() && regions[last][1] == (bounds[2] >> 9) + b)
+                last++;
+            auto [top, bottom] = band_range(b);
+            job.frame = make_frame(job, width, bounds, top, bottom);
+            allocate_rows(job, chunk_rows, bounds, top, bottom);
+            render_dimension(job, regions, first, last, bounds, options.jobs, count);
+            send(b);
+            first = last;
+        }
+    }
+    else
+    {
+        // render every region at once, and send each band on as soon as its last region is done
+        std::thread renderer([&]()
+                             { render_dimension(job, regions, 0, regions.size(), bounds, options.jobs, count); });
+        for (int b = 0; b < rangez; b++)
+        {
+            job.band_tracker.wait(b);
+            send(b);
+        }
+        renderer.join();
+    }
+    std::cout << "\nFinishing image...\n";
+    bands.close();
+    writer.join();
+    {
+        StageTimer timer(main_stats.deflate_time);
+        if (raw)
+            raw->finish();
+        if (png)
+            png->finish();
+        else if (tiles)
+            tiles->finish();
+        if (heights)
+            heights->finish();
+        if (water)
+            water->finish();
     }
-    std::cout << "\nCreating image...\n";
-    write_file(output);
+    if (!options.blocks_path.empty())
+        write_block_counts(options.blocks_path, job.region_stats, job.region_blocks);
+    if (tiles)
+        std::cout << "Wrote " << tiles->levels << " zoom levels of tiles.\n";
+    if (!options.report_path.empty())
+        write_report(options.report_path, std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count(), main_stats, job.thread_stats, job.region_stats);
     std::cout << "Done.\nExecution time: " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count() << " ms" << std::endl;
     return 0;
 }
+
+#ifndef MCMAP_NO_MAIN
+inline bool parse_scale(const std::string_view name, int &shift)
+{
+    // the scale named on the command line, which has to be 1, 2, 4, 8 or 16, as the shift it stands for
+    for (int s = 0; s <= 4; s++)
+        if (name == std::to_string(1 << s))
+        {
+            shift = s;
+            return true;
+        }
+    return false;
+}
+
+int main(int argc, char *argv[])
+{
+    // the command line, read into a Job and the options of the run, which render_world() does the rest of
+    Job job;
+    RunOptions options;
+    std::string convert_path;
+    job.dimension = find_dimension(std::filesystem::current_path());
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc)
+            options.jobs = std::max(1, std::stoi(argv[++i]));
+        else if (arg.starts_with("-j"))
+            options.jobs = std::max(1, std::stoi(arg.substr(2)));
+        else if (arg == "--stream")
+            options.stream = true;
+        else if (arg == "--tiles" && i + 1 < argc)
+        {
+            options.tile_dir = argv[++i];
+            options.stream = true;
+        }
+        else if (arg == "--tile-size" && i + 1 < argc)
+            options.tile_size = std::clamp(static_cast<int>(std::bit_floor(std::stoul(argv[++i]))), 16, 4096);
+        else if (arg == "--cache" && i + 1 < argc)
+            job.cache_dir = argv[++i];
+        else if (arg == "--level" && i + 1 < argc)
+            options.level = std::clamp(std::stoi(argv[++i]), 0, 9);
+        else if (arg == "--deflate-threads" && i + 1 < argc)
+            options.deflate_threads = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--report" && i + 1 < argc)
+            options.report_path = argv[++i];
+        else if (arg == "--progress" && i + 1 < argc)
+            job.progress_interval = std::max(0.0, std::stod(argv[++i]));
+        else if (arg == "--scale" && i + 1 < argc && parse_scale(argv[i + 1], job.scale_shift))
+            i++;
+        else if (arg == "--dimension" && i + 1 < argc && parse_dimension(argv[i + 1], job.dimension))
+            i++;
+        else if (arg == "--layout" && i + 1 < argc && parse_layout(argv[i + 1], job.layout))
+            i++;
+        else if (arg == "--raw" && i + 1 < argc)
+            options.raw_path = argv[++i];
+        else if (arg == "--heights" && i + 1 < argc)
+        {
+            options.heights_path = argv[++i];
+            job.rasters = true;
+        }
+        else if (arg == "--water" && i + 1 < argc)
+        {
+            options.water_path = argv[++i];
+            job.rasters = true;
+        }
+        else if (arg == "--blocks" && i + 1 < argc)
+        {
+            options.blocks_path = argv[++i];
+            job.count_blocks = true;
+        }
+        else if (arg == "--no-png")
+            options.write_png = false;
+        else if (arg == "--convert" && i + 1 < argc)
+            convert_path = argv[++i];
+        else if (arg == "--crop" && i + 4 < argc)
+        {
+            // two opposite corners, in block coordinates
+            int x0 = std::stoi(argv[++i]), z0 = std::stoi(argv[++i]), x1 = std::stoi(argv[++i]), z1 = std::stoi(argv[++i]);
+            options.crop[0] = std::min(x0, x1);
+            options.crop[1] = std::max(x0, x1);
+            options.crop[2] = std::min(z0, z1);
+            options.crop[3] = std::max(z0, z1);
+            options.cropped = true;
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [-j threads] [--stream] [--cache dir] [--tiles dir] [--tile-size pixels] [--level 0-9] [--deflate-threads threads] [--report file.json] [--progress seconds] [--scale 1|2|4|8|16] [--dimension overworld|nether|end] [--crop x1 z1 x2 z2] [--layout rows|tiles] [--raw file] [--no-png] [--heights file] [--water file] [--blocks file]\n       " << argv[0] << " --convert file [--tiles dir] [--tile-size pixels] [--level 0-9] [--deflate-threads threads]\n";
+            return 1;
+        }
+    }
+    if (!convert_path.empty())
+        return convert_raw(convert_path, options.tile_dir, options.tile_size, options.level, options.deflate_threads ? options.deflate_threads : options.jobs);
+    return render_world(job, options);
+}
+#endif
@@ -0,0 +1,80 @@
+/*  The C interface for rendering from other programs, with everything in memory
+    Copyright (C) 2025 Anonymous1212144
+    See copyright notice in map.cpp
+*/
+
+#ifndef MCMAP_H
+#define MCMAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*  Build map.cpp with -DMCMAP_NO_MAIN (e.g. g++ -O2 -std=c++23 -shared -fPIC -DMCMAP_NO_MAIN map.cpp -lz
+    -o libmcmap.so) and include this header to call it. Pixels are palette indices, the same as in the PNG,
+    whose colours mcmap_palette() gives. A renderer holds the decoding state of one dimension at one scale
+    and may be used by one thread at a time, but any number of renderers can be used at once on separate
+    threads, since nothing is shared between them. Only the functions and values here are kept stable; the
+    version goes up whenever any of them change */
+#define MCMAP_API_VERSION 1
+
+enum mcmap_dimension
+{
+    MCMAP_OVERWORLD = 0,
+    MCMAP_NETHER = 1,
+    MCMAP_END = 2
+};
+
+/* chunk compression, as in the byte before each chunk of a region file */
+enum mcmap_compression
+{
+    MCMAP_GZIP = 1,
+    MCMAP_ZLIB = 2,
+    MCMAP_NONE = 3,
+    MCMAP_LZ4 = 4
+};
+
+enum mcmap_status
+{
+    MCMAP_OK = 0,
+    MCMAP_EMPTY = 1,    /* nothing to draw: no heightmap, or a chunk still being generated */
+    MCMAP_INVALID = -1, /* an argument out of range, or data that could not be decompressed */
+    MCMAP_FAILED = -2   /* out of memory */
+};
+
+typedef struct mcmap_renderer mcmap_renderer;
+
+int mcmap_api_version(void);
+
+/* the RGB colours of the palette indices, 3 bytes each into rgb (room for 256), returning how many there are */
+int mcmap_palette(uint8_t *rgb);
+
+/* a renderer for a dimension, drawing one pixel for every scale by scale blocks (1, 2, 4, 8 or 16), or NULL */
+mcmap_renderer *mcmap_renderer_new(int dimension, int scale);
+void mcmap_renderer_free(mcmap_renderer *renderer);
+
+/*  Draw one chunk, given as it is stored in a region file after its 5 byte header, into 16 / scale rows of
+    16 / scale pixels, stride bytes apart. The top row is shaded against north (the heights of the blocks
+    just north of the chunk, as written to heights by the chunk north of it) or left as if nothing is there
+    when north is NULL. If heights is not NULL, the height of every pixel is written to it, a row at a time */
+int mcmap_render_chunk(mcmap_renderer *renderer, const uint8_t *data, size_t size, int compression, const int16_t *north, uint8_t *pixels, size_t stride, int16_t *heights);
+
+/*  Draw a whole region file in memory into 512 / scale rows of 512 / scale pixels, stride bytes apart, with
+    its top row shaded as if nothing is north of it. Chunks too large for the region file, which the game
+    keeps in their own .mcc files, are left out */
+int mcmap_render_region(mcmap_renderer *renderer, const uint8_t *data, size_t size, uint8_t *pixels, size_t stride);
+
+/*  Encode height rows of width pixels, stride bytes apart, as a PNG at a zlib level (0-9). On success *png
+    points to the file and *size is its length, to be given back with mcmap_free() */
+int mcmap_encode_png(const uint8_t *pixels, uint32_t width, uint32_t height, size_t stride, int level, uint8_t **png, size_t *size);
+void mcmap_free(void *memory);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,109 @@
+/*  Helpers for walking NBT data in place, without copying or allocating
+    Copyright (C) 2025 Anonymous1212144
+    See copyright notice in map.cpp
+*/
+
+#ifndef NBT_H
+#define NBT_H
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+enum TagType : uint8_t
+{
+    TAG_END,
+    TAG_BYTE,
+    TAG_SHORT,
+    TAG_INT,
+    TAG_LONG,
+    TAG_FLOAT,
+    TAG_DOUBLE,
+    TAG_BYTE_ARRAY,
+    TAG_STRING,
+    TAG_LIST,
+    TAG_COMPOUND,
+    TAG_INT_ARRAY,
+    TAG_LONG_ARRAY
+};
+
+// payload size of the fixed size tags, and the element size of the array tags
+inline constexpr uint8_t TAG_SIZES[13] = {0, 1, 2, 4, 8, 4, 8, 1, 0, 0, 0, 4, 8};
+
+inline uint16_t read_u16(const uint8_t *&ptr)
+{
+    uint16_t n;
+    std::memcpy(&n, ptr, 2);
+    ptr += 2;
+    return std::byteswap(n);
+}
+
+inline uint32_t read_u32(const uint8_t *&ptr)
+{
+    uint32_t n;
+    std::memcpy(&n, ptr, 4);
+    ptr += 4;
+    return std::byteswap(n);
+}
+
+inline std::string_view read_string(const uint8_t *&ptr)
+{
+    // a view into the buffer, valid for as long as the buffer is
+    uint16_t n = read_u16(ptr);
+    std::string_view s(reinterpret_cast<const char *>(ptr), n);
+    ptr += n;
+    return s;
+}
+
+inline void skip_payload(const uint8_t *&ptr, const uint8_t type);
+
+template <typename F>
+inline void scan_compound(const uint8_t *&ptr, F &&visit)
+{
+    // walk the tags of a compound up to its end tag; visit(type, name) reads the payload and returns true
+    // if it wants the tag, and the payloads of the other tags are skipped
+    while (uint8_t type = *ptr++)
+    {
+        std::string_view name = read_string(ptr);
+        if (!visit(type, name))
+            skip_payload(ptr, type);
+    }
+}
+
+inline void skip_payload(const uint8_t *&ptr, const uint8_t type)
+{
+    switch (type)
+    {
+    case TAG_BYTE_ARRAY:
+    case TAG_INT_ARRAY:
+    case TAG_LONG_ARRAY:
+    {
+        uint32_t n = read_u32(ptr);
+        ptr += static_cast<size_t>(n) * TAG_SIZES[type];
+        break;
+    }
+    case TAG_STRING:
+        ptr += read_u16(ptr);
+        break;
+    case TAG_LIST:
+    {
+        uint8_t element = *ptr++;
+        uint32_t n = read_u32(ptr);
+        if (element < TAG_BYTE_ARRAY)
+            ptr += static_cast<size_t>(n) * TAG_SIZES[element];
+        else
+            while (n--)
+                skip_payload(ptr, element);
+        break;
+    }
+    case TAG_COMPOUND:
+        scan_compound(ptr, [](uint8_t, std::string_view) { return false; });
+        break;
+    default:
+        ptr += TAG_SIZES[type];
+        break;
+    }
+}
+
+#endif
@@ -0,0 +1,94 @@
+/*  The hand-offs between the stages of rendering, which let reading, decoding and compressing overlap
+    Copyright (C) 2025 Anonymous1212144
+    See copyright notice in map.cpp
+*/
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+template <typename T>
+class BoundedQueue
+{
+public:
+    // Hands items from one stage to the next, making the stage before wait once capacity items are waiting,
+    // so that a slow consumer bounds how far ahead (and how much memory) the producer gets. The items are
+    // whole bands of rows, so a lock per item costs nothing next to the work on it
+    explicit BoundedQueue(const size_t capacity) : capacity(capacity) {}
+
+    void push(T item)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [&]
+                      { return items.size() < capacity; });
+        items.push_back(std::move(item));
+        not_empty.notify_one();
+    }
+
+    bool pop(T &item)
+    {
+        // false once the queue is closed and empty
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [&]
+                       { return !items.empty() || closed; });
+        if (items.empty())
+            return false;
+        item = std::move(items.front());
+        items.pop_front();
+        not_full.notify_one();
+        return true;
+    }
+
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        not_empty.notify_all();
+    }
+
+private:
+    size_t capacity;
+    std::deque<T> items;
+    bool closed = false;
+    std::mutex mutex;
+    std::condition_variable not_full;
+    std::condition_variable not_empty;
+};
+
+class BandTracker
+{
+public:
+    // counts down the regions left in each band, so that a band can be shaded and compressed as soon as its
+    // last region is drawn, while the workers go on with the bands after it
+    void reset(std::vector<int> counts)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        remaining = std::move(counts);
+    }
+
+    void done(const size_t band)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (band < remaining.size() && !--remaining[band])
+            finished.notify_all();
+    }
+
+    void wait(const size_t band)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [&]
+                      { return band >= remaining.size() || remaining[band] <= 0; });
+    }
+
+private:
+    std::vector<int> remaining;
+    std::mutex mutex;
+    std::condition_variable finished;
+};
+
+#endif
@@ -0,0 +1,344 @@
+/*  A PNG writer that compresses scanlines as they are handed to it, optionally on several threads
+    Copyright (C) 2025 Anonymous1212144
+    See copyright notice in map.cpp
+*/
+
+#ifndef PNG_H
+#define PNG_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+#include "format.h"
+#include "zlib.h"
+
+inline std::vector<uint8_t> png_header(uint32_t width, uint32_t height, const int grey_bits = 0)
+{
+    // the header from format.h with the image size filled in, or for a greyscale image of grey_bits per
+    // pixel, just its signature and IHDR chunk, without the palette
+    std::vector<uint8_t> header = FORMAT;
+    if (grey_bits)
+    {
+        header.resize(33);
+        header[24] = grey_bits;
+        header[25] = 0;
+    }
+    width = std::byteswap(width);
+    height = std::byteswap(height);
+    std::memcpy(&header[16], &width, 4);
+    std::memcpy(&header[20], &height, 4);
+    uint32_t crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, reinterpret_cast<const Bytef *>(&header[12]), 17);
+    crc = std::byteswap(crc);
+    std::memcpy(&header[29], &crc, 4);
+    return header;
+}
+
+inline std::vector<const uint8_t *> scanline_pointers(const std::vector<std::vector<uint8_t>> &rows)
+{
+    // rows kept as vectors (a filter byte and the pixels, or empty for a row of zeros) in the form the
+    // writers take them
+    std::vector<const uint8_t *> lines(rows.size());
+    for (size_t r = 0; r < rows.size(); r++)
+        lines[r] = rows[r].empty() ? nullptr : rows[r].data();
+    return lines;
+}
+
+class PngWriter
+{
+public:
+    PngWriter(const std::string &path, const uint32_t width, const uint32_t height, const int level = 9, const int threads = 1, const size_t chunk_size = 1 << 20, const int grey_bits = 0)
+        : level(level), threads(threads), grey_bits(grey_bits), row_size(static_cast<size_t>(width) * std::max(1, grey_bits / 8) + 1), buffer(chunk_size)
+    {
+        file.open(path, std::ios::binary);
+        start(width, height);
+    }
+
+    PngWriter(std::ostream &stream, const uint32_t width, const uint32_t height, const int level = 9, const int threads = 1, const size_t chunk_size = 1 << 20, const int grey_bits = 0)
+        : level(level), threads(threads), grey_bits(grey_bits), row_size(static_cast<size_t>(width) * std::max(1, grey_bits / 8) + 1), out(&stream), buffer(chunk_size)
+    {
+        // write to a stream the caller keeps open, such as a std::ostringstream to make the PNG in memory
+        start(width, height);
+    }
+
+    ~PngWriter()
+    {
+        if (threads <= 1)
+            deflateEnd(&strm);
+    }
+
+    PngWriter(const PngWriter &) = delete;
+    PngWriter &operator=(const PngWriter &) = delete;
+
+    void write(const std::span<const uint8_t *const> rows)
+    {
+        // compress a run of scanlines, each pointing to its filter byte, where nullptr stands for a scanline
+        // of zeros. Scanlines that follow one another in memory are compressed as one piece
+        size_t empty = 0;
+        for (size_t r = 0; r < rows.size();)
+        {
+            if (!rows[r])
+            {
+                empty++;
+                r++;
+                continue;
+            }
+            if (empty)
+            {
+                write_empty(empty);
+                empty = 0;
+            }
+            if (threads > 1)
+            {
+                pending.insert(pending.end(), rows[r], rows[r] + row_size);
+                if (pending.size() >= BLOCK_SIZE * BATCH * threads)
+                    compress_batch(false);
+                r++;
+                continue;
+            }
+            const uint8_t *piece = rows[r];
+            size_t size = 0;
+            do
+                size += row_size;
+            while (++r < rows.size() && rows[r] == piece + size && size < MAX_PIECE);
+            adler = adler32_z(adler, piece, size);
+            strm.next_in = const_cast<Bytef *>(piece);
+            strm.avail_in = size;
+            while (strm.avail_in)
+                pump(Z_NO_FLUSH);
+        }
+        if (empty)
+            write_empty(empty);
+    }
+
+    void write(const std::vector<std::vector<uint8_t>> &rows)
+    {
+        write(scanline_pointers(rows));
+    }
+
+    void finish()
+    {
+        // flush the rest of the stream and end the file
+        if (threads > 1)
+            compress_batch(true);
+        else
+            while (pump(Z_FINISH) != Z_STREAM_END)
+                ;
+        uint32_t check = std::byteswap(adler);
+        emit(reinterpret_cast<const uint8_t *>(&check), 4);
+        if (used)
+            write_chunk(used);
+        out->write("\0\0\0\0IEND\xae\x42\x60\x82", 12);
+        if (file.is_open())
+            file.close();
+        else
+            out->flush();
+    }
+
+private:
+    static constexpr size_t BLOCK_SIZE = 131072;
+    static constexpr size_t BATCH = 8;
+    static constexpr size_t WINDOW = 32768;
+    static constexpr size_t MAX_PIECE = 1 << 30; // the most deflate is given at once, well inside its 32 bit count
+
+    int level;
+    int threads;
+    int grey_bits; // 8 or 16 for a greyscale image, or 0 for palette indices
+    size_t row_size;
+    std::ofstream file;
+    std::ostream *out = &file;
+    z_stream strm{};
+    std::vector<uint8_t> buffer;
+    uint32_t used = 0;
+
+    std::vector<uint8_t> pending;
+    std::vector<uint8_t> window;
+    uint32_t adler = adler32(0L, Z_NULL, 0);
+
+    size_t empty_rows = 0;
+    std::vector<uint8_t> empty_piece;
+    uint32_t empty_adler;
+
+    void start(const uint32_t width, const uint32_t height)
+    {
+        // the PNG header, then the start of the zlib stream
+        std::vector<uint8_t> header = png_header(width, height, grey_bits);
+        out->write(reinterpret_cast<const char *>(header.data()), header.size());
+        // zlib header for a 32K window at this level, written by hand since the data is raw deflate, so that
+        // precomputed runs of empty rows can be spliced into it
+        uint16_t head = (0x78 << 8) | ((level >= 9 ? 3 : level == 1 ? 0 : level >= 6 ? 1 : 2) << 6);
+        head += 31 - head % 31;
+        uint8_t bytes[2] = {static_cast<uint8_t>(head >> 8), static_cast<uint8_t>(head)};
+        emit(bytes, 2);
+        if (threads > 1)
+            pending.reserve(BLOCK_SIZE * BATCH * threads);
+        else
+            deflateInit2(&strm, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+    }
+
+    std::vector<uint8_t> deflate_zeros(const size_t size) const
+    {
+        // raw deflate of a run of zeros on its own, ending on a sync flush so it can go anywhere in the stream
+        std::vector<uint8_t> zeros(size);
+        z_stream block{};
+        deflateInit2(&block, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+        std::vector<uint8_t> out(deflateBound(&block, size) + 16);
+        block.next_in = zeros.data();
+        block.avail_in = size;
+        block.next_out = out.data();
+        block.avail_out = out.size();
+        deflate(&block, Z_SYNC_FLUSH);
+        out.resize(out.size() - block.avail_out);
+        deflateEnd(&block);
+        return out;
+    }
+
+    void write_empty(size_t rows)
+    {
+        // a run of empty scanlines, copied from a piece of deflate data made once for a megabyte of them,
+        // after ending what came before on a byte boundary with nothing referring back past it
+        if (threads > 1)
+        {
+            if (pending.size())
+                compress_batch(false);
+        }
+        else
+        {
+            strm.avail_in = 0;
+            do
+                pump(Z_FULL_FLUSH);
+            while (!strm.avail_out);
+        }
+        if (empty_piece.empty())
+        {
+            empty_rows = std::max<size_t>(1, (1 << 20) / row_size);
+            empty_piece = deflate_zeros(empty_rows * row_size);
+            std::vector<uint8_t> zeros(empty_rows * row_size);
+            empty_adler = adler32(1L, zeros.data(), zeros.size());
+        }
+        size_t size = rows * row_size;
+        for (; rows >= empty_rows; rows -= empty_rows)
+        {
+            emit(empty_piece.data(), empty_piece.size());
+            adler = adler32_combine(adler, empty_adler, empty_rows * row_size);
+        }
+        if (rows)
+        {
+            std::vector<uint8_t> piece = deflate_zeros(rows * row_size);
+            std::vector<uint8_t> zeros(rows * row_size);
+            emit(piece.data(), piece.size());
+            adler = adler32(adler, zeros.data(), zeros.size());
+        }
+        if (threads > 1)
+        {
+            window.insert(window.end(), std::min(size, WINDOW), 0);
+            if (window.size() > WINDOW)
+                window.erase(window.begin(), window.end() - WINDOW);
+        }
+    }
+
+    void compress_batch(const bool last)
+    {
+        // deflate the pending input as independent blocks in parallel, in the manner of pigz: each block
+        // is primed with the 32K before it and ends on a sync flush, so the pieces join into one stream
+        size_t count = std::max<size_t>(1, (pending.size() + BLOCK_SIZE - 1) / BLOCK_SIZE);
+        std::vector<std::vector<uint8_t>> out(count);
+        std::vector<uint32_t> checks(count);
+        std::atomic<size_t> next = 0;
+        auto work = [&]()
+        {
+            size_t k;
+            while ((k = next++) < count)
+            {
+                size_t begin = k * BLOCK_SIZE;
+                size_t length = std::min(BLOCK_SIZE, pending.size() - begin);
+                z_stream block{};
+                deflateInit2(&block, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+                if (k)
+                    deflateSetDictionary(&block, &pending[begin - WINDOW], WINDOW);
+                else if (window.size())
+                    deflateSetDictionary(&block, window.data(), window.size());
+                out[k].resize(deflateBound(&block, length) + 16);
+                block.next_in = pending.data() + begin;
+                block.avail_in = length;
+                block.next_out = out[k].data();
+                block.avail_out = out[k].size();
+                deflate(&block, last && k == count - 1 ? Z_FINISH : Z_SYNC_FLUSH);
+                out[k].resize(out[k].size() - block.avail_out);
+                deflateEnd(&block);
+                checks[k] = adler32(1L, pending.data() + begin, length);
+            }
+        };
+        std::vector<std::thread> pool;
+        for (int t = 1; t < std::min<int>(threads, count); t++)
+            pool.emplace_back(work);
+        work();
+        for (auto &thread : pool)
+            thread.join();
+
+        for (size_t k = 0; k < count; k++)
+        {
+            emit(out[k].data(), out[k].size());
+            adler = adler32_combine(adler, checks[k], std::min(BLOCK_SIZE, pending.size() - k * BLOCK_SIZE));
+        }
+        size_t keep = std::min(WINDOW, pending.size());
+        if (keep)
+            window.assign(pending.end() - keep, pending.end());
+        pending.clear();
+    }
+
+    void emit(const uint8_t *bytes, size_t size)
+    {
+        // append compressed bytes to the current IDAT chunk
+        while (size)
+        {
+            size_t n = std::min<size_t>(size, buffer.size() - used);
+            std::memcpy(&buffer[used], bytes, n);
+            used += n;
+            bytes += n;
+            size -= n;
+            if (used == buffer.size())
+            {
+                write_chunk(used);
+                used = 0;
+            }
+        }
+    }
+
+    int pump(const int flush)
+    {
+        // run deflate into the buffer, writing it out as an IDAT chunk whenever it fills up
+        strm.next_out = &buffer[used];
+        strm.avail_out = buffer.size() - used;
+        int ret = deflate(&strm, flush);
+        used = buffer.size() - strm.avail_out;
+        if (used == buffer.size())
+        {
+            write_chunk(used);
+            used = 0;
+        }
+        return ret;
+    }
+
+    void write_chunk(const uint32_t size)
+    {
+        uint32_t size2 = std::byteswap(size);
+        out->write(reinterpret_cast<char *>(&size2), 4);
+        uint32_t crc = crc32(0L, Z_NULL, 0);
+        out->write("IDAT", 4);
+        crc = crc32(crc, reinterpret_cast<const Bytef *>("IDAT"), 4);
+        out->write(reinterpret_cast<char *>(buffer.data()), size);
+        crc = crc32(crc, reinterpret_cast<const Bytef *>(buffer.data()), size);
+        crc = std::byteswap(crc);
+        out->write(reinterpret_cast<char *>(&crc), 4);
+    }
+};
+
+#endif
@@ -0,0 +1,87 @@
+/*  Greyscale rasters made alongside the map: the height of the surface and the depth of the water over it
+    Copyright (C) 2025 Anonymous1212144
+    See copyright notice in map.cpp
+*/
+
+#ifndef RASTER_H
+#define RASTER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+#include "png.h"
+#include "raw.h"
+
+template <typename T>
+class RasterWriter
+{
+public:
+    // A raster the size of the map with a sample of type T (uint8_t or uint16_t) for every pixel: a
+    // greyscale PNG when the path ends in .png, or otherwise just the samples one row after another, little
+    // endian, with nothing before them (the raw heightmaps that terrain tools read, such as .r16 files)
+    RasterWriter(const std::string &path, const uint32_t width, const uint32_t height, const int level = 9, const int threads = 1) : width(width)
+    {
+        if (path.ends_with(".png"))
+        {
+            png = std::make_unique<PngWriter>(path, width, height, level, threads, 1 << 20, sizeof(T) * 8);
+            lines.resize(width * sizeof(T) + 1);
+        }
+        else
+        {
+            file.open(path, std::ios::binary);
+            lines.resize(width * sizeof(T));
+        }
+    }
+
+    void write(const std::span<const T *const> rows)
+    {
+        // add rows of width samples, where nullptr stands for a row of zeros
+        if (!png)
+        {
+            for (const T *row : rows)
+            {
+                std::fill(lines.begin(), lines.end(), 0);
+                if (row)
+                    for (uint32_t x = 0; x < width; x++)
+                        put_le<T>(lines, x * sizeof(T), row[x]);
+                file.write(reinterpret_cast<const char *>(lines.data()), lines.size());
+            }
+            return;
+        }
+        // as big endian PNG scanlines, a band at a time, with rows of zeros left to the writer's shortcut
+        size_t size = width * sizeof(T) + 1;
+        lines.assign(rows.size() * size, 0);
+        std::vector<const uint8_t *> scanlines(rows.size());
+        for (size_t r = 0; r < rows.size(); r++)
+        {
+            if (!rows[r] || std::all_of(rows[r], rows[r] + width, [](T v) { return !v; }))
+                continue;
+            uint8_t *line = &lines[r * size];
+            for (uint32_t x = 0; x < width; x++)
+                for (size_t b = 0; b < sizeof(T); b++)
+                    line[1 + x * sizeof(T) + b] = rows[r][x] >> ((sizeof(T) - 1 - b) * 8);
+            scanlines[r] = line;
+        }
+        png->write(scanlines);
+    }
+
+    void finish()
+    {
+        if (png)
+            png->finish();
+        else
+            file.close();
+    }
+
+private:
+    uint32_t width;
+    std::unique_ptr<PngWriter> png;
+    std::ofstream file;
+    std::vector<uint8_t> lines;
+};
+
+#endif
@@ -0,0 +1,254 @@
+/*  A tiled, uncompressed file of the map's palette indices, for other tools to map into memory and read in place
+    Copyright (C) 2025 Anonymous1212144
+    See copyright notice in map.cpp
+*/
+
+#ifndef RAW_H
+#define RAW_H
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+#include "format.h"
+#include "region.h"
+
+// The layout of the file, with every number little endian:
+//     0    "MCMAPRAW"
+//     8    uint32 version, width, height and tile size in pixels
+//     24   int32 block x and z of the top left pixel, uint32 blocks per pixel, uint32 colours in the palette
+//     40   256 RGB palette entries, the same palette (and so the same indices) as the PNG
+//     808  uint64 file offset of every tile, a row of tiles at a time, or 0 for a tile with nothing in it
+// followed by the tiles themselves, each tile size squared bytes of palette indices a row at a time, starting on
+// a 4096 byte boundary so that every tile lies on its own pages. Tiles at the right and bottom edges are padded
+// out with zeros to the full size
+inline constexpr char RAW_MAGIC[8] = {'M', 'C', 'M', 'A', 'P', 'R', 'A', 'W'};
+inline constexpr uint32_t RAW_VERSION = 1;
+inline constexpr size_t RAW_PALETTE = 40;
+inline constexpr size_t RAW_INDEX = RAW_PALETTE + 256 * 3;
+inline constexpr size_t RAW_ALIGN = 4096;
+
+template <typename T>
+inline T little_endian(const T n)
+{
+    if constexpr (std::endian::native == std::endian::big)
+        return std::byteswap(n);
+    return n;
+}
+
+template <typename T>
+inline void put_le(std::vector<uint8_t> &bytes, const size_t at, const T n)
+{
+    T le = little_endian(n);
+    std::memcpy(&bytes[at], &le, sizeof(T));
+}
+
+template <typename T>
+inline T get_le(const uint8_t *bytes, const size_t at)
+{
+    T n;
+    std::memcpy(&n, bytes + at, sizeof(T));
+    return little_endian(n);
+}
+
+class RawWriter
+{
+public:
+    RawWriter(const std::string &path, const uint32_t width, const uint32_t height, const int west, const int north, const int scale, const int tile_size = 256)
+        : width(width), tile_size(tile_size), columns((width + tile_size - 1) / tile_size),
+          index(static_cast<size_t>(columns) * ((height + tile_size - 1) / tile_size)),
+          strip(static_cast<size_t>(tile_size) * columns * tile_size), tile(static_cast<size_t>(tile_size) * tile_size)
+    {
+        // write the header with the palette from format.h and leave room for the index, which is filled in
+        // once every tile is written
+        std::vector<uint8_t> header(RAW_INDEX + index.size() * 8);
+        std::memcpy(header.data(), RAW_MAGIC, 8);
+        put_le<uint32_t>(header, 8, RAW_VERSION);
+        put_le<uint32_t>(header, 12, width);
+        put_le<uint32_t>(header, 16, height);
+        put_le<uint32_t>(header, 20, tile_size);
+        put_le<int32_t>(header, 24, west);
+        put_le<int32_t>(header, 28, north);
+        put_le<uint32_t>(header, 32, scale);
+        uint32_t colours = std::byteswap(get_le<uint32_t>(FORMAT.data(), 33)) / 3;
+        put_le<uint32_t>(header, 36, colours);
+        std::copy_n(FORMAT.begin() + 41, colours * 3, header.begin() + RAW_PALETTE);
+        header.resize((header.size() + RAW_ALIGN - 1) & ~(RAW_ALIGN - 1));
+        file.open(path, std::ios::binary);
+        file.write(reinterpret_cast<const char *>(header.data()), header.size());
+        offset = header.size();
+    }
+
+    void write(const std::span<const uint8_t *const> rows)
+    {
+        // add scanlines, each pointing to its filter byte, where nullptr stands for a scanline of zeros
+        for (const uint8_t *row : rows)
+        {
+            uint8_t *line = &strip[static_cast<size_t>(filled) * columns * tile_size];
+            if (!row)
+                std::fill_n(line, width, 0);
+            else
+                std::copy_n(row + 1, width, line);
+            if (++filled == tile_size)
+                write_strip();
+        }
+    }
+
+    void finish()
+    {
+        // write out the partly filled strip at the bottom, then the index
+        if (filled)
+        {
+            std::fill(strip.begin() + static_cast<size_t>(filled) * columns * tile_size, strip.end(), 0);
+            write_strip();
+        }
+        std::vector<uint8_t> bytes(index.size() * 8);
+        for (size_t t = 0; t < index.size(); t++)
+            put_le<uint64_t>(bytes, t * 8, index[t]);
+        file.seekp(RAW_INDEX);
+        file.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+        file.close();
+    }
+
+private:
+    uint32_t width;
+    int tile_size;
+    uint32_t columns;
+    std::vector<uint64_t> index;
+    std::vector<uint8_t> strip;
+    std::vector<uint8_t> tile;
+    std::ofstream file;
+    uint64_t offset;
+    int filled = 0;
+    size_t tile_row = 0;
+
+    void write_strip()
+    {
+        // cut a full row of tiles out of the strip, skipping the ones with nothing in them
+        size_t stride = static_cast<size_t>(columns) * tile_size;
+        for (uint32_t x = 0; x < columns; x++)
+        {
+            for (int r = 0; r < tile_size; r++)
+                std::copy_n(&strip[r * stride + x * tile_size], tile_size, &tile[static_cast<size_t>(r) * tile_size]);
+            if (std::all_of(tile.begin(), tile.end(), [](uint8_t p) { return !p; }))
+                continue;
+            file.write(reinterpret_cast<const char *>(tile.data()), tile.size());
+            index[tile_row * columns + x] = offset;
+            offset += tile.size();
+        }
+        filled = 0;
+        tile_row++;
+    }
+};
+
+class RawMap
+{
+public:
+    // A raw map file mapped into memory (the same way as a region file), which any part of can be read from
+    // without copying the rest. Nothing is valid unless valid() is true
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t tile_size = 0;
+    int west = 0;
+    int north = 0;
+    uint32_t scale = 1;
+    uint32_t colours = 0;
+
+    explicit RawMap(const std::string &path) : file(path)
+    {
+        if (file.size < RAW_INDEX || std::memcmp(file.data, RAW_MAGIC, 8) || get_le<uint32_t>(file.data, 8) != RAW_VERSION)
+            return;
+        width = get_le<uint32_t>(file.data, 12);
+        height = get_le<uint32_t>(file.data, 16);
+        tile_size = get_le<uint32_t>(file.data, 20);
+        west = get_le<int32_t>(file.data, 24);
+        north = get_le<int32_t>(file.data, 28);
+        scale = get_le<uint32_t>(file.data, 32);
+        colours = std::min<uint32_t>(get_le<uint32_t>(file.data, 36), 256);
+        if (!tile_size)
+            return;
+        columns = (width + tile_size - 1) / tile_size;
+        rows = (height + tile_size - 1) / tile_size;
+        if (file.size < RAW_INDEX + static_cast<size_t>(columns) * rows * 8)
+            return;
+        ok = true;
+    }
+
+    bool valid() const
+    {
+        return ok;
+    }
+
+    const uint8_t *palette() const
+    {
+        // the colours RGB triples, in the order of the indices
+        return file.data + RAW_PALETTE;
+    }
+
+    const uint8_t *tile(const uint32_t tx, const uint32_t tz) const
+    {
+        // the tile_size by tile_size indices of one tile, a row at a time, or nullptr if it is all zeros (or
+        // would run past the end of the file)
+        if (tx >= columns || tz >= rows)
+            return nullptr;
+        uint64_t at = get_le<uint64_t>(file.data, RAW_INDEX + (static_cast<size_t>(tz) * columns + tx) * 8);
+        if (!at || at + static_cast<uint64_t>(tile_size) * tile_size > file.size)
+            return nullptr;
+        return file.data + at;
+    }
+
+    uint8_t at(const uint32_t x, const uint32_t z) const
+    {
+        // the palette index of one pixel
+        const uint8_t *t = tile(x / tile_size, z / tile_size);
+        return t ? t[(z % tile_size) * tile_size + x % tile_size] : 0;
+    }
+
+    void read(const uint32_t x, const uint32_t z, const uint32_t w, const uint32_t h, uint8_t *out, const size_t stride) const
+    {
+        // copy the w by h pixels from (x, z) into out, stride bytes apart per row, with zeros outside the map
+        for (uint32_t r = 0; r < h; r++)
+        {
+            uint8_t *line = out + r * stride;
+            uint32_t row = z + r;
+            std::fill_n(line, w, 0);
+            if (row >= height)
+                continue;
+            for (uint32_t c = x; c < std::min(x + w, width);)
+            {
+                uint32_t end = std::min({x + w, width, (c / tile_size + 1) * tile_size});
+                if (const uint8_t *t = tile(c / tile_size, row / tile_size))
+                    std::copy_n(t + (row % tile_size) * tile_size + c % tile_size, end - c, line + (c - x));
+                c = end;
+            }
+        }
+    }
+
+    std::vector<std::vector<uint8_t>> scanlines(const uint32_t first, const uint32_t last) const
+    {
+        // rows [first, last) in the form the PNG and tile writers take them: a filter byte before each row,
+        // and an empty vector for a row of zeros
+        std::vector<std::vector<uint8_t>> lines(last - first);
+        for (uint32_t z = first; z < last; z++)
+        {
+            std::vector<uint8_t> &line = lines[z - first];
+            line.resize(width + 1);
+            read(0, z, width, 1, line.data() + 1, width);
+            if (std::all_of(line.begin(), line.end(), [](uint8_t p) { return !p; }))
+                line.clear();
+        }
+        return lines;
+    }
+
+private:
+    RegionFile file;
+    uint32_t columns = 0;
+    uint32_t rows = 0;
+    bool ok = false;
+};
+
+#endif
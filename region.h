@@ -0,0 +1,147 @@
+/*  A read-only view of a region file, mapped into memory where possible
+    Copyright (C) 2025 Anonymous1212144
+    See copyright notice in map.cpp
+*/
+
+#ifndef REGION_H
+#define REGION_H
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#ifdef _WIN32
+#include <fstream>
+#include <vector>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+class RegionFile
+{
+public:
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+    std::string path; // empty for a region handed over in memory
+
+    explicit RegionFile(const std::string &path) : path(path)
+    {
+#ifdef _WIN32
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+            return;
+        buffer.resize(file.tellg());
+        file.seekg(0, std::ios::beg);
+        file.read(reinterpret_cast<char *>(buffer.data()), buffer.size());
+        data = buffer.data();
+        size = buffer.size();
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+        struct stat st;
+        if (!fstat(fd, &st) && st.st_size > 0)
+        {
+            void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED)
+            {
+                data = static_cast<const uint8_t *>(map);
+                size = st.st_size;
+                mapped = true;
+                // chunks are laid out by sector offset rather than by chunk index, so readahead past the
+                // chunk being read is mostly wasted; prefetch() asks for each chunk's sectors instead
+                madvise(map, size, MADV_RANDOM);
+                madvise(map, std::min<size_t>(size, 8192), MADV_WILLNEED);
+            }
+        }
+        close(fd);
+#endif
+    }
+
+    RegionFile(const uint8_t *bytes, const size_t length) : data(bytes), size(length)
+    {
+        // a view of a whole region file already in memory, which is left alone: never unmapped, and never
+        // advised about, since dropping its pages would lose the caller's data
+    }
+
+    ~RegionFile()
+    {
+#ifndef _WIN32
+        if (mapped)
+            munmap(const_cast<uint8_t *>(data), size);
+#endif
+    }
+
+    RegionFile(const RegionFile &) = delete;
+    RegionFile &operator=(const RegionFile &) = delete;
+
+    uint32_t location(const int i) const
+    {
+        // entry i of the location table: sector offset in the upper 24 bits, sector count in the lowest 8
+        uint32_t loc;
+        std::memcpy(&loc, data + (i << 2), 4);
+        return std::byteswap(loc);
+    }
+
+    uint32_t timestamp(const int i) const
+    {
+        // entry i of the timestamp table: when the chunk was last saved, in seconds since the epoch
+        uint32_t time;
+        std::memcpy(&time, data + 4096 + (i << 2), 4);
+        return std::byteswap(time);
+    }
+
+    void prefetch(const uint32_t loc) const
+    {
+        // start reading a chunk's sectors in one request before they are touched
+#ifndef _WIN32
+        advise(loc, MADV_WILLNEED);
+#endif
+    }
+
+    void release(const uint32_t loc) const
+    {
+        // drop a chunk's pages once it has been inflated, keeping the resident set small
+#ifndef _WIN32
+        advise(loc, MADV_DONTNEED);
+#endif
+    }
+
+private:
+#ifdef _WIN32
+    std::vector<uint8_t> buffer;
+#else
+    bool mapped = false;
+
+    void advise(const uint32_t loc, const int advice) const
+    {
+        size_t page = sysconf(_SC_PAGESIZE);
+        size_t begin = static_cast<size_t>(loc >> 8) << 12;
+        size_t end = std::min(size, begin + (static_cast<size_t>(loc & 255) << 12));
+        if (!mapped || !loc || begin >= end)
+            return;
+        begin &= ~(page - 1);
+        madvise(const_cast<uint8_t *>(data) + begin, end - begin, advice);
+    }
+#endif
+};
+
+inline void prefetch_file(const std::string &path)
+{
+    // have the whole file read into the page cache in the background, so that it is already there by the
+    // time a worker maps it
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    close(fd);
+#endif
+}
+
+#endif
@@ -0,0 +1,65 @@
+/*  The second pass of rendering, which shades each block against the block north of it a row at a time
+    Copyright (C) 2025 Anonymous1212144
+    See copyright notice in map.cpp
+*/
+
+#ifndef SHADE_H
+#define SHADE_H
+
+#include <cstddef>
+#include <cstdint>
+#include "cache.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define SHADE_SSE2
+#include <emmintrin.h>
+#endif
+
+inline uint8_t shade(const int h, const int north)
+{
+    // brightness bits of a block given the height of the block north of it
+    if (h < north)
+        return 0;
+    else if (h == north)
+        return 1 << 6;
+    else
+        return 2 << 6;
+}
+
+inline void shade_row(uint8_t *row, const int16_t *heights, const int16_t *north, const size_t n)
+{
+    // replace the UNSHADED bits of a row with the brightness from the heights of the row and the row north of
+    // it, where a missing block to the north counts as one below the world, like the north edge of the map
+    size_t x = 0;
+#ifdef SHADE_SSE2
+    const __m128i missing = _mm_set1_epi16(NO_HEIGHT);
+    const __m128i below = _mm_set1_epi16(-1);
+    const __m128i flat = _mm_set1_epi16(1 << 6);
+    const __m128i up = _mm_set1_epi16(2 << 6);
+    const __m128i marker = _mm_set1_epi8(static_cast<char>(UNSHADED));
+    auto brightness = [&](const size_t at)
+    {
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i *>(heights + at));
+        __m128i n = _mm_loadu_si128(reinterpret_cast<const __m128i *>(north + at));
+        __m128i gone = _mm_cmpeq_epi16(n, missing);
+        n = _mm_or_si128(_mm_andnot_si128(gone, n), _mm_and_si128(gone, below));
+        __m128i same = _mm_cmpeq_epi16(h, n);
+        __m128i bits = _mm_or_si128(_mm_and_si128(same, flat), _mm_andnot_si128(same, up));
+        return _mm_andnot_si128(_mm_cmplt_epi16(h, n), bits);
+    };
+    for (; x + 16 <= n; x += 16)
+    {
+        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + x));
+        __m128i bits = _mm_packus_epi16(brightness(x), brightness(x + 8));
+        __m128i unshaded = _mm_cmpeq_epi8(_mm_and_si128(p, marker), marker);
+        __m128i shaded = _mm_or_si128(_mm_andnot_si128(marker, p), bits);
+        p = _mm_or_si128(_mm_andnot_si128(unshaded, p), _mm_and_si128(unshaded, shaded));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(row + x), p);
+    }
+#endif
+    for (; x < n; x++)
+        if ((row[x] & UNSHADED) == UNSHADED)
+            row[x] = (row[x] & ~UNSHADED) | shade(heights[x], north[x] == NO_HEIGHT ? -1 : north[x]);
+}
+
+#endif
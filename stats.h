@@ -0,0 +1,169 @@
+/*  Counters and timers for each worker, and the JSON report made from them, along with the counts of blocks
+    Copyright (C) 2025 Anonymous1212144
+    See copyright notice in map.cpp
+*/
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "colours.h"
+
+using Clock = std::chrono::steady_clock;
+
+inline double since(const Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+struct Stats
+{
+    // Everything a worker counts, kept in its own context and only added together once the workers have
+    // finished, so counting needs no locks or atomics
+    uint64_t bytes_read = 0;
+    uint64_t compressed_bytes = 0;
+    uint64_t inflated_bytes = 0;
+    uint64_t chunks_decoded = 0;
+    uint64_t chunks_cached = 0;
+    uint64_t chunks_skipped = 0;
+    uint64_t chunks_unfinished = 0;
+    uint64_t sections = 0;
+    uint64_t palettes = 0;
+    uint64_t palette_lookups = 0;
+    uint64_t walk_steps = 0;
+    double read_time = 0;
+    double inflate_time = 0;
+    double parse_time = 0;
+    double render_time = 0;
+    double deflate_time = 0;
+
+    Stats &operator+=(const Stats &other)
+    {
+        bytes_read += other.bytes_read;
+        compressed_bytes += other.compressed_bytes;
+        inflated_bytes += other.inflated_bytes;
+        chunks_decoded += other.chunks_decoded;
+        chunks_cached += other.chunks_cached;
+        chunks_skipped += other.chunks_skipped;
+        chunks_unfinished += other.chunks_unfinished;
+        sections += other.sections;
+        palettes += other.palettes;
+        palette_lookups += other.palette_lookups;
+        walk_steps += other.walk_steps;
+        read_time += other.read_time;
+        inflate_time += other.inflate_time;
+        parse_time += other.parse_time;
+        render_time += other.render_time;
+        deflate_time += other.deflate_time;
+        return *this;
+    }
+};
+
+struct RegionStats
+{
+    int x;
+    int z;
+    uint64_t chunks = 0;
+    double seconds = 0;
+};
+
+class StageTimer
+{
+public:
+    // adds the time from its creation to its destruction to a total
+    StageTimer(double &total) : total(total), start(Clock::now()) {}
+
+    ~StageTimer()
+    {
+        total += since(start);
+    }
+
+    StageTimer(const StageTimer &) = delete;
+    StageTimer &operator=(const StageTimer &) = delete;
+
+private:
+    double &total;
+    Clock::time_point start;
+};
+
+inline void write_stats(std::ostream &out, const Stats &s)
+{
+    out << "{\"bytes_read\": " << s.bytes_read
+        << ", \"compressed_bytes\": " << s.compressed_bytes
+        << ", \"inflated_bytes\": " << s.inflated_bytes
+        << ", \"chunks_decoded\": " << s.chunks_decoded
+        << ", \"chunks_cached\": " << s.chunks_cached
+        << ", \"chunks_skipped\": " << s.chunks_skipped
+        << ", \"chunks_unfinished\": " << s.chunks_unfinished
+        << ", \"sections\": " << s.sections
+        << ", \"palettes\": " << s.palettes
+        << ", \"palette_lookups\": " << s.palette_lookups
+        << ", \"walk_steps\": " << s.walk_steps
+        << ", \"seconds\": {\"read\": " << s.read_time
+        << ", \"inflate\": " << s.inflate_time
+        << ", \"parse\": " << s.parse_time
+        << ", \"render\": " << s.render_time
+        << ", \"deflate\": " << s.deflate_time << "}}";
+}
+
+inline void write_report(const std::string &path, const double seconds, const Stats &main, const std::vector<Stats> &threads, const std::vector<RegionStats> &regions)
+{
+    // the totals, each worker's share of them, and how long each region took, slowest regions first
+    Stats total = main;
+    for (const Stats &s : threads)
+        total += s;
+    std::vector<RegionStats> sorted = regions;
+    std::stable_sort(sorted.begin(), sorted.end(), [](const RegionStats &a, const RegionStats &b)
+                     { return a.seconds > b.seconds; });
+    std::ofstream out(path);
+    out << "{\n  \"seconds\": " << seconds << ",\n  \"threads\": " << threads.size() << ",\n  \"total\": ";
+    write_stats(out, total);
+    out << ",\n  \"per_thread\": [";
+    for (size_t t = 0; t < threads.size(); t++)
+    {
+        out << (t ? ",\n    " : "\n    ");
+        write_stats(out, threads[t]);
+    }
+    out << "\n  ],\n  \"per_region\": [";
+    for (size_t r = 0; r < sorted.size(); r++)
+        out << (r ? ",\n    " : "\n    ") << "{\"x\": " << sorted[r].x << ", \"z\": " << sorted[r].z << ", \"chunks\": " << sorted[r].chunks << ", \"seconds\": " << sorted[r].seconds << "}";
+    out << "\n  ]\n}\n";
+}
+
+inline void write_block_counts(const std::string &path, const std::vector<RegionStats> &regions, const std::vector<std::vector<uint64_t>> &counts)
+{
+    // the blocks seen from above in each region, most common first, as CSV if the path ends in .csv and JSON
+    // otherwise. A pixel counts once, so at a reduced scale each count stands for scale by scale blocks
+    bool csv = path.ends_with(".csv");
+    std::ofstream out(path);
+    out << (csv ? "x,z,block,count\n" : "{\n  \"regions\": [");
+    for (size_t r = 0; r < counts.size(); r++)
+    {
+        std::vector<size_t> order;
+        for (size_t b = 1; b < counts[r].size(); b++)
+            if (counts[r][b])
+                order.push_back(b);
+        std::stable_sort(order.begin(), order.end(), [&](const size_t a, const size_t b)
+                         { return counts[r][a] > counts[r][b]; });
+        if (!csv)
+            out << (r ? ",\n    " : "\n    ") << "{\"x\": " << regions[r].x << ", \"z\": " << regions[r].z << ", \"blocks\": {";
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            if (csv)
+                out << regions[r].x << "," << regions[r].z << "," << COLOURS[order[i]].name << "," << counts[r][order[i]] << "\n";
+            else
+                out << (i ? ", " : "") << "\"" << COLOURS[order[i]].name << "\": " << counts[r][order[i]];
+        }
+        if (!csv)
+            out << "}}";
+    }
+    if (!csv)
+        out << "\n  ]\n}\n";
+}
+
+#endif
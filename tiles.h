@@ -0,0 +1,177 @@
+/*  A writer for a pyramid of fixed size PNG tiles, in a z/x/y directory layout
+    Copyright (C) 2025 Anonymous1212144
+    See copyright notice in map.cpp
+*/
+
+#ifndef TILES_H
+#define TILES_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+#include "png.h"
+
+class TileWriter
+{
+public:
+    int levels;
+
+    TileWriter(const std::filesystem::path &dir, const int tile_size, const uint32_t width, const uint32_t height, const int level = 9, const int threads = 1)
+        : dir(dir), tile_size(tile_size), level(level), threads(threads)
+    {
+        // one zoom level per halving, down to the level where the whole map fits in one tile
+        levels = 1;
+        while ((std::max(width, height) - 1) >> (levels - 1) >= static_cast<uint32_t>(tile_size))
+            levels++;
+        for (int k = 0; k < levels; k++)
+        {
+            Level &l = scales.emplace_back();
+            l.width = ((width - 1) >> k) + 1;
+            l.strip.assign(tile_size, std::vector<uint8_t>(l.width));
+            l.prev.resize(l.width);
+        }
+        blank.resize(width);
+    }
+
+    void write(const std::span<const uint8_t *const> rows)
+    {
+        // add full resolution scanlines, each pointing to its filter byte, where nullptr stands for a
+        // scanline of zeros
+        for (const uint8_t *row : rows)
+            add_row(0, row ? row + 1 : blank.data());
+    }
+
+    void write(const std::vector<std::vector<uint8_t>> &rows)
+    {
+        write(scanline_pointers(rows));
+    }
+
+    void finish()
+    {
+        // write out the partly filled strips at the bottom of every level, along with the rows they make
+        for (int k = 0; k < levels; k++)
+        {
+            Level &l = scales[k];
+            if (l.rows & 1 && k + 1 < levels)
+            {
+                std::vector<uint8_t> blank(l.width);
+                downsample(k, blank.data());
+            }
+            if (l.filled)
+            {
+                for (int r = l.filled; r < tile_size; r++)
+                    std::fill(l.strip[r].begin(), l.strip[r].end(), 0);
+                write_strip(k);
+            }
+        }
+    }
+
+private:
+    struct Level
+    {
+        uint32_t width;
+        std::vector<std::vector<uint8_t>> strip;
+        std::vector<uint8_t> prev;
+        int filled = 0;
+        int tile_row = 0;
+        uint32_t rows = 0;
+    };
+
+    std::filesystem::path dir;
+    int tile_size;
+    int level;
+    int threads;
+    std::vector<Level> scales;
+    std::vector<uint8_t> blank;
+
+    void add_row(const int k, const uint8_t *row)
+    {
+        // append a row to a level, and every second row also makes a row of the level below it
+        Level &l = scales[k];
+        std::copy_n(row, l.width, l.strip[l.filled].begin());
+        if (++l.filled == tile_size)
+        {
+            write_strip(k);
+            l.filled = 0;
+        }
+        if (k + 1 < levels)
+        {
+            if (l.rows & 1)
+                downsample(k, row);
+            else
+                std::copy_n(row, l.width, l.prev.begin());
+        }
+        l.rows++;
+    }
+
+    void downsample(const int k, const uint8_t *row)
+    {
+        // combine the held row of a level with the one below it into a row of the next level
+        Level &l = scales[k];
+        std::vector<uint8_t> half(scales[k + 1].width);
+        for (uint32_t x = 0; x < half.size(); x++)
+        {
+            uint32_t x2 = std::min(2 * x + 1, l.width - 1);
+            half[x] = pick(l.prev[2 * x], l.prev[x2], row[2 * x], row[x2]);
+        }
+        add_row(k + 1, half.data());
+    }
+
+    static uint8_t pick(const uint8_t a, const uint8_t b, const uint8_t c, const uint8_t d)
+    {
+        // the most common of four palette indices, favouring the top left, since indices can't be averaged
+        if (a == b || a == c || a == d)
+            return a;
+        if (b == c || b == d)
+            return b;
+        if (c == d)
+            return c;
+        return a;
+    }
+
+    void write_strip(const int k)
+    {
+        // encode a full row of tiles, skipping the ones with nothing in them
+        Level &l = scales[k];
+        int count = (l.width + tile_size - 1) / tile_size;
+        std::filesystem::path zoom = dir / std::to_string(levels - 1 - k);
+        std::atomic<int> next = 0;
+        auto work = [&]()
+        {
+            int x;
+            std::vector<std::vector<uint8_t>> tile(tile_size, std::vector<uint8_t>(tile_size + 1));
+            while ((x = next++) < count)
+            {
+                uint32_t begin = x * tile_size;
+                uint32_t length = std::min<uint32_t>(tile_size, l.width - begin);
+                bool empty = true;
+                for (int r = 0; r < tile_size; r++)
+                {
+                    std::fill(tile[r].begin() + 1 + length, tile[r].end(), 0);
+                    std::copy_n(l.strip[r].begin() + begin, length, tile[r].begin() + 1);
+                    empty = empty && std::all_of(tile[r].begin() + 1, tile[r].end(), [](uint8_t p) { return !p; });
+                }
+                if (empty)
+                    continue;
+                std::filesystem::create_directories(zoom / std::to_string(x));
+                PngWriter png((zoom / std::to_string(x) / (std::to_string(l.tile_row) + ".png")).string(), tile_size, tile_size, level, 1, 1 << 16);
+                png.write(tile);
+                png.finish();
+            }
+        };
+        std::vector<std::thread> pool;
+        for (int t = 1; t < std::min(threads, count); t++)
+            pool.emplace_back(work);
+        work();
+        for (auto &thread : pool)
+            thread.join();
+        l.tile_row++;
+    }
+};
+
+#endif
@@ -0,0 +1,178 @@
+/*  Kernels that turn packed long arrays into flat arrays, picked at runtime from what the CPU supports
+    Copyright (C) 2025 Anonymous1212144
+    See copyright notice in map.cpp
+*/
+
+#ifndef UNPACK_H
+#define UNPACK_H
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define UNPACK_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TARGET_SSSE3
+#define TARGET_AVX2
+#else
+#define TARGET_SSSE3 __attribute__((target("ssse3")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// entries written past the end of an unpacked array, which the output buffers must leave room for
+const int UNPACK_SLACK = 16;
+
+using ByteswapFn = void (*)(const uint8_t *, uint64_t *, size_t);
+using UnpackFn = void (*)(const uint64_t *, uint16_t *, size_t);
+
+inline void byteswap_scalar(const uint8_t *src, uint64_t *dst, size_t n)
+{
+    for (size_t j = 0; j < n; j++)
+    {
+        std::memcpy(&dst[j], src + (j << 3), 8);
+        dst[j] = std::byteswap(dst[j]);
+    }
+}
+
+template <int N>
+void unpack_scalar(const uint64_t *longs, uint16_t *out, size_t count)
+{
+    // entries don't cross long boundaries, so each long holds 64 / N of them from its lowest bits up
+    constexpr int D = 64 / N;
+    constexpr uint64_t MASK = (1ULL << N) - 1;
+    for (size_t l = 0; l < count; l++)
+    {
+        uint64_t v = longs[l];
+        for (int e = 0; e < D; e++)
+            out[l * D + e] = (v >> (e * N)) & MASK;
+    }
+}
+
+inline void unpack_any(const uint64_t *longs, uint16_t *out, size_t count, const int n)
+{
+    // fallback for widths without a specialised kernel
+    int d = 64 / n;
+    uint64_t mask = (1ULL << n) - 1;
+    for (size_t l = 0; l < count; l++)
+        for (int e = 0; e < d; e++)
+            out[l * d + e] = (longs[l] >> (e * n)) & mask;
+}
+
+#ifdef UNPACK_X86
+TARGET_SSSE3 inline void byteswap_ssse3(const uint8_t *src, uint64_t *dst, size_t n)
+{
+    const __m128i order = _mm_set_epi8(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7);
+    size_t j = 0;
+    for (; j + 2 <= n; j += 2)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + (j << 3)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + j), _mm_shuffle_epi8(v, order));
+    }
+    byteswap_scalar(src + (j << 3), dst + j, n - j);
+}
+
+TARGET_AVX2 inline void byteswap_avx2(const uint8_t *src, uint64_t *dst, size_t n)
+{
+    const __m256i order = _mm256_set_epi8(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7,
+                                          8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7);
+    size_t j = 0;
+    for (; j + 4 <= n; j += 4)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + (j << 3)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + j), _mm256_shuffle_epi8(v, order));
+    }
+    byteswap_scalar(src + (j << 3), dst + j, n - j);
+}
+
+template <int N>
+TARGET_AVX2 void unpack_avx2(const uint64_t *longs, uint16_t *out, size_t count)
+{
+    // shift one long four ways at once for four neighbouring entries, then narrow them to 16 bits; the
+    // last group of a long can spill up to three entries, which the next long overwrites
+    constexpr int D = 64 / N;
+    const __m256i mask = _mm256_set1_epi64x((1ULL << N) - 1);
+    const __m256i narrow = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    for (size_t l = 0; l < count; l++)
+    {
+        __m256i v = _mm256_set1_epi64x(longs[l]);
+        for (int e = 0; e < D; e += 4)
+        {
+            __m256i shifts = _mm256_setr_epi64x(e * N, (e + 1) * N, (e + 2) * N, (e + 3) * N);
+            __m256i entries = _mm256_and_si256(_mm256_srlv_epi64(v, shifts), mask);
+            __m128i low = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(entries, narrow));
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(out + l * D + e), _mm_packus_epi32(low, low));
+        }
+    }
+}
+
+inline bool has_avx2()
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuidex(info, 7, 0);
+    return info[1] & (1 << 5);
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+inline bool has_ssse3()
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    return info[2] & (1 << 9);
+#else
+    return __builtin_cpu_supports("ssse3");
+#endif
+}
+#endif
+
+struct Kernels
+{
+    // the kernels for this CPU, with an unpacker specialised for every width from 4 to 12 bits
+    ByteswapFn byteswap = byteswap_scalar;
+    UnpackFn unpack[13] = {};
+
+    Kernels()
+    {
+        fill<4>(std::make_integer_sequence<int, 9>{}, false);
+#ifdef UNPACK_X86
+        if (has_ssse3())
+            byteswap = byteswap_ssse3;
+        if (has_avx2())
+        {
+            byteswap = byteswap_avx2;
+            fill<4>(std::make_integer_sequence<int, 9>{}, true);
+        }
+#endif
+    }
+
+    template <int First, int... I>
+    void fill(std::integer_sequence<int, I...>, const bool avx2)
+    {
+#ifdef UNPACK_X86
+        ((unpack[First + I] = avx2 ? unpack_avx2<First + I> : unpack_scalar<First + I>), ...);
+#else
+        ((unpack[First + I] = unpack_scalar<First + I>), ...);
+#endif
+    }
+};
+
+inline const Kernels KERNELS;
+
+inline void unpack_longs(const uint64_t *longs, uint16_t *out, size_t count, const int n)
+{
+    // unpack count longs of n bit entries, writing up to UNPACK_SLACK entries past the last one
+    if (n >= 4 && n <= 12)
+        KERNELS.unpack[n](longs, out, count);
+    else
+        unpack_any(longs, out, count, n);
+}
+
+#endif